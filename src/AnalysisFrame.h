@@ -0,0 +1,39 @@
+#ifndef ANALYSIS_FRAME_H
+#define ANALYSIS_FRAME_H
+
+#include <__new/interference_size.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "constants.h"
+
+/*
+        Analysis Frame
+
+        Fixed-layout payload handed from the AnalyzerThread to consumers via
+   the TripleBuffer. No heap storage, so swapping frames never allocates.
+
+        * sequence: incremented once per published hop, 0 means the frame has
+   never been written. Gaps reveal dropped frames, repeats reveal re-reads.
+        * samplePosition: number of input samples consumed when the hop was
+   analyzed, i.e. the stream position of the newest sample in the window.
+   Counted at the input rate, before any resampling to the analysis rate.
+        * captureTimeNs: NowNanos() at the start of the audio callback that
+   delivered the hop's newest sample, carried through the BroadcastRing with
+   the samples. Offline it is when the decoded chunk was pushed.
+        * producerTimeNs: NowNanos() when the frame was published, for
+   staleness measurement on the consumer side.
+*/
+
+struct alignas(std::hardware_destructive_interference_size) AnalysisFrame {
+  constexpr static size_t BIN_COUNT = Constants::FFT_SIZE / 2;
+
+  std::array<float, BIN_COUNT> spectrum{};
+  uint64_t sequence{0};
+  uint64_t samplePosition{0};
+  int64_t captureTimeNs{0};
+  int64_t producerTimeNs{0};
+};
+
+#endif
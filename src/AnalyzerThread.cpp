@@ -1,127 +1,163 @@
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 
 #include "AnalyzerThread.h"
-#include "RingBuffer.h"
+#include "Clock.h"
+#include "Denormals.h"
 #include <iostream>
 #include <cassert>
 using namespace std;
 using namespace Constants;
 
-AnalyzerThread::AnalyzerThread(RingBuffer &inputQueue,
-                               TripleBuffer<vector<float>> &swapLocation,
+AnalyzerThread::AnalyzerThread(BroadcastRing &input,
+                               TripleBuffer<AnalysisFrame> &swapLocation,
                                atomic<bool> &doneFlag)
-    : inputQueue(inputQueue), swapLocation(swapLocation), doneFlag(doneFlag),
-      buckets(swapLocation.producerWriteBuffer()) {
-  this->Initialize();
-}
+    : input(input), swapLocation(swapLocation), doneFlag(doneFlag),
+      buckets(swapLocation.producerWriteBuffer()) {}
 
-void AnalyzerThread::Initialize() {
-  for (int i = 0; i < FFT_SIZE; ++i) {
-    this->mHannTable[i] =
-        0.54f - 0.46f * cosf(2.0f * PI * static_cast<float>(i) /
-                             static_cast<float>(FFT_SIZE - 1));
+void AnalyzerThread::operator()() {
+  ThreadTuning::Apply("analyzer", this->tuning);
+  // window tails and fades into silence would otherwise hit subnormals
+  DisableDenormals();
+  while (!doneFlag) {
+    Update();
   }
 }
 
-// Cooley-Turkey FFT
-// (in-place, breadth-first, decimation-in-frequency)
-// Taken from rosettacode.org
-// https://rosettacode.org/wiki/Fast_Fourier_transform#C.2B.2B
-void AnalyzerThread::fft(ComplexArray &d) {
-  // DFT
-  unsigned int N = d.size(), k = N, n;
-  double thetaT = 3.14159265358979323846264338328L / N;
-  ComplexValue phiT = ComplexValue(cos(thetaT), -sin(thetaT)), T;
-  while (k > 1) {
-    n = k;
-    k >>= 1;
-    phiT = phiT * phiT;
-    T = 1.0L;
-    for (unsigned int l = 0; l < k; l++) {
-      for (unsigned int a = l; a < N; a += n) {
-        unsigned int b = a + k;
-        ComplexValue t = d[a] - d[b];
-        d[a] += d[b];
-        d[b] = t * T;
-      }
-      T *= phiT;
-    }
-  }
-  // Decimate
-  unsigned int m = (unsigned int)log2(N);
-  for (unsigned int a = 0; a < N; a++) {
-    unsigned int b = a;
-    // Reverse bits
-    b = (((b & 0xaaaaaaaa) >> 1) | ((b & 0x55555555) << 1));
-    b = (((b & 0xcccccccc) >> 2) | ((b & 0x33333333) << 2));
-    b = (((b & 0xf0f0f0f0) >> 4) | ((b & 0x0f0f0f0f) << 4));
-    b = (((b & 0xff00ff00) >> 8) | ((b & 0x00ff00ff) << 8));
-    b = ((b >> 16) | (b << 16)) >> (32 - m);
-    if (b > a) {
-      ComplexValue t = d[a];
-      d[a] = d[b];
-      d[b] = t;
-    }
-  }
-  // Normalize
-  ComplexValue f = 1.0 / sqrt(N);
-  for (unsigned int i = 0; i < N; i++)
-    d[i] *= f;
+void AnalyzerThread::Configure(const uint32_t inputRate,
+                               const uint32_t analysisRate) {
+  this->analysisRate = analysisRate == 0 ? inputRate : analysisRate;
+  this->resampler.Configure(inputRate, this->analysisRate);
+  this->pending.clear();
+  this->pending.reserve(2 * HOP_SIZE);
 }
 
-void AnalyzerThread::operator()() {
-  while (!doneFlag) {
-    Update();
+uint32_t AnalyzerThread::GetAnalysisRate() const { return this->analysisRate; }
+
+void AnalyzerThread::SetTuning(const ThreadTuning::Settings &settings) {
+  this->tuning = settings;
+}
+
+void AnalyzerThread::Launch() {
+  // only a running analyzer reads the ring; subscribed but never launched
+  // (cache playback) it would just be lapped over and over
+  this->inputId = this->input.Subscribe(BroadcastRing::LagPolicy::SkipForward);
+  if (this->inputId < 0) {
+    std::cerr << "Analyzer: no free broadcast reader\n";
+    return;
   }
+  this->mThread = std::thread(std::ref(*this));
 }
 
-void AnalyzerThread::Launch() { this->mThread = std::thread(std::ref(*this)); }
+bool AnalyzerThread::IsLaunched() const { return this->inputId >= 0; }
 
 AnalyzerThread::~AnalyzerThread() {
   if (mThread.joinable()) {
     mThread.join();
   }
+  if (this->inputId >= 0) {
+    this->input.Unsubscribe(this->inputId);
+  }
 }
 
-void AnalyzerThread::GetSamples() {
-  if (inputQueue.GetAvailable() >= HOP_SIZE) {
-    // move window HOP_SIZE items over
-    std::copy(this->samples.begin() + HOP_SIZE, this->samples.end(),
-              this->samples.begin());
-
-    constexpr size_t writeIndex = FFT_SIZE - HOP_SIZE;
-    float val;
-    for (int i = 0; i < HOP_SIZE; ++i) {
-      inputQueue.PopFront(val);
-      this->samples[writeIndex + i] = {val, 0};
+bool AnalyzerThread::GetSamples() {
+  // sleep until the audio callback has published enough input for a full
+  // hop at the analysis rate; the timeout keeps doneFlag responsive when
+  // playback stops
+  constexpr auto waitTimeout = std::chrono::milliseconds(20);
+  while (this->pending.size() < HOP_SIZE) {
+    // after a seek, restart the window instead of blending in audio from
+    // before it; the cursor keeps counting the flushed samples
+    size_t discarded = 0;
+    if (this->input.TakeFlush(this->inputId, discarded)) {
+      this->analyzer.Reset();
+      this->resampler.Reset();
+      this->pending.clear();
+    }
+    const size_t needed =
+        this->resampler.InputNeeded(HOP_SIZE - this->pending.size());
+    this->inputTarget.store(this->input.GetCursor(this->inputId) + needed,
+                            std::memory_order_release);
+    if (!this->input.WaitForAvailable(this->inputId, needed, waitTimeout)) {
+      return false;
+    }
+    this->inputScratch.resize(needed);
+    const uint64_t before = this->input.GetCursor(this->inputId);
+    const size_t got =
+        this->input.Pop(this->inputId, this->inputScratch.data(), needed);
+    const uint64_t after = this->input.GetCursor(this->inputId);
+    // lapped: the ring skipped us forward, so what is pending is no longer
+    // contiguous with what was just read
+    if (after - before != got) {
+      this->analyzer.Reset();
+      this->resampler.Reset();
+      this->pending.clear();
     }
+    this->resampler.Process(this->inputScratch.data(), got, this->pending);
+    this->samplesConsumed = after;
   }
-}
+  // when the callback handed over the hop's newest sample, not when we woke
+  const int64_t stampNs = this->input.StampAt(this->samplesConsumed - 1);
+  this->captureTimeNs = stampNs != 0 ? stampNs : NowNanos();
 
-void AnalyzerThread::ApplyHanning() {
-  for (int i = 0; i < FFT_SIZE; ++i) {
-    this->fftData[i] *= this->mHannTable[i];
-  }
+  this->analyzer.PushHop(this->pending.data());
+  this->pending.erase(this->pending.begin(), this->pending.begin() + HOP_SIZE);
+  return true;
 }
 
 void AnalyzerThread::Update() {
-  this->GetSamples();
-  this->fftData = ComplexArray(this->samples.data(), FFT_SIZE);
-  this->ApplyHanning();
-  this->fft(this->fftData);
-
-  constexpr float dbFloor = 60.0f;
-  constexpr float invRange = 1.0f / dbFloor;
-  constexpr float dbAdd = dbFloor;
-
-  const size_t binCount = this->fftData.size() / 2;
-  for (int i = 0; i < binCount; ++i) {
-    const auto squaredMag = static_cast<float>(std::norm(this->fftData[i]));
-    const float db = 10.0f * log10f(squaredMag + 1e-12f);
-    float normalized = (db + dbAdd) * invRange;
-    (*this->buckets)[i] = std::clamp(normalized, 0.0f, 1.0f);
+  if (!this->GetSamples()) {
+    return;
   }
+  const int64_t busyStartNs = NowNanos();
+  this->analyzer.Compute(this->buckets->spectrum);
+
+  this->buckets->sequence = ++this->sequence;
+  this->buckets->samplePosition = this->samplesConsumed;
+  this->buckets->captureTimeNs = this->captureTimeNs;
+  this->buckets->producerTimeNs = NowNanos();
 
   this->swapLocation.swapProducer(this->buckets);
+
+  this->hopCount.store(this->sequence, std::memory_order_relaxed);
+  this->busyNs.store(this->busyNs.load(std::memory_order_relaxed) +
+                         (NowNanos() - busyStartNs),
+                     std::memory_order_relaxed);
+}
+
+uint64_t AnalyzerThread::GetHopCount() const {
+  return this->hopCount.load(std::memory_order_relaxed);
+}
+
+int64_t AnalyzerThread::GetBusyNanos() const {
+  return this->busyNs.load(std::memory_order_relaxed);
+}
+
+bool AnalyzerThread::Drain(const std::chrono::milliseconds timeout) const {
+  if (!this->IsLaunched()) {
+    return true;
+  }
+  // the backlog alone can't tell: with resampling a hop can need more input
+  // than HOP_SIZE. The target only passes the pushed input once the
+  // analyzer asks for samples that are not there; while it is still
+  // working through what it has, the last target is at or behind its cursor
+  const int64_t timeoutNs =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+  const int64_t startNs = NowNanos();
+  while (this->input.GetSamplesPushed() >=
+         this->inputTarget.load(std::memory_order_acquire)) {
+    if (timeoutNs > 0 && NowNanos() - startNs >= timeoutNs) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+BroadcastRing::ConsumerStats AnalyzerThread::GetInputStats() const {
+  if (this->inputId < 0) {
+    return {};
+  }
+  return this->input.GetStats(this->inputId);
 }
\ No newline at end of file
@@ -1,25 +1,26 @@
 #ifndef ANALYZER_THREAD_H
 #define ANALYZER_THREAD_H
 
-#include <array>
 #include <atomic>
-#include <complex>
+#include <chrono>
 #include <memory>
 #include <thread>
-#include <valarray>
 #include <vector>
 
-#include "RingBuffer.h"
+#include "AnalysisFrame.h"
+#include "BroadcastRing.h"
+#include "Resampler.h"
+#include "SpectrumAnalyzer.h"
+#include "ThreadTuning.h"
 #include "TripleBuffer.h"
 #include "constants.h"
 
-typedef std::complex<double> ComplexValue;
-typedef std::valarray<ComplexValue> ComplexArray;
-
 class AnalyzerThread {
 public:
-  AnalyzerThread(RingBuffer &inputQueue,
-                 TripleBuffer<std::vector<float>> &swapLocation,
+  // reads its own cursor of input from Launch() on, skipping ahead if it
+  // falls behind
+  AnalyzerThread(BroadcastRing &input,
+                 TripleBuffer<AnalysisFrame> &swapLocation,
                  std::atomic<bool> &doneFlag);
   AnalyzerThread(const AnalyzerThread &) = delete;
   AnalyzerThread(AnalyzerThread &&) = delete;
@@ -28,25 +29,56 @@ public:
   ~AnalyzerThread();
 
   void operator()();
+  // Subscribes to the input and starts the thread; on failure nothing
+  // starts and IsLaunched() stays false
   void Launch();
+  bool IsLaunched() const;
+
+  // Resample the input to analysisRate before the FFT (0 keeps the input
+  // rate). Call before Launch().
+  void Configure(uint32_t inputRate, uint32_t analysisRate);
+  uint32_t GetAnalysisRate() const;
+
+  // Affinity and scheduling applied when the thread starts. Call before
+  // Launch().
+  void SetTuning(const ThreadTuning::Settings &settings);
 
+  // hops analyzed and time spent analyzing them (excludes waiting)
+  uint64_t GetHopCount() const;
+  int64_t GetBusyNanos() const;
+  BroadcastRing::ConsumerStats GetInputStats() const;
+
+  // Once the input has stopped growing, waits until every hop it completes
+  // has been analyzed and the analyzer is waiting for input that has not
+  // arrived. A zero timeout waits as long as that takes; false on timeout.
+  bool Drain(std::chrono::milliseconds timeout =
+                 std::chrono::milliseconds::zero()) const;
 
 private:
-  void fft(ComplexArray &data);
-  void GetSamples();
-  void Initialize();
-  void ApplyHanning();
+  bool GetSamples();
   void Update();
 
-  std::array<ComplexValue, Constants::FFT_SIZE> samples = {0};
-  std::array<float, Constants::FFT_SIZE> mHannTable = {0.0f};
-
-  ComplexArray fftData;
-  RingBuffer &inputQueue;
-  TripleBuffer<std::vector<float>> &swapLocation;
-  std::unique_ptr<std::vector<float>> buckets;
-  std::thread mThread;
+  SpectrumAnalyzer analyzer;
+  BroadcastRing &input;
+  int inputId{-1};
+  TripleBuffer<AnalysisFrame> &swapLocation;
   std::atomic<bool> &doneFlag;
+  std::unique_ptr<AnalysisFrame> buckets;
+  std::thread mThread;
+
+  Resampler resampler;
+  uint32_t analysisRate{0};
+  std::vector<float> inputScratch;
+  std::vector<float> pending;
+  ThreadTuning::Settings tuning;
+
+  uint64_t sequence{0};
+  uint64_t samplesConsumed{0};
+  int64_t captureTimeNs{0};
+  // input position the analyzer is waiting to reach, for Drain()
+  std::atomic<uint64_t> inputTarget{0};
+  std::atomic<uint64_t> hopCount{0};
+  std::atomic<int64_t> busyNs{0};
 };
 
 #endif
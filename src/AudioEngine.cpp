@@ -1,48 +1,126 @@
 #include "AudioEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <string>
+#include <thread>
+
+#include "Clock.h"
+#include "Denormals.h"
 
 void AudioEngine::ma_data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
+	const uint64_t beginCycles = DeadlineMonitor::Begin();
+	const int64_t callbackStartNs = NowNanos();
+	// the backend owns this thread, so only flush denormals for our own work
+	const ScopedNoDenormals noDenormals;
 	auto* pEngine = static_cast<AudioEngine *>(pDevice->pUserData);
 
 	auto* pOutputF32 = static_cast<float*>(pOutput);
+	pEngine->RecordCallbackTiming(callbackStartNs, frameCount);
 
-	if (pEngine->decoder.pBackendVTable == NULL) {
+	if (!pEngine->readAhead) {
 		memset(pOutput, 0, frameCount * ma_get_bytes_per_frame(pDevice->playback.format, pDevice->playback.channels));
 		return;
 	}
 
-	ma_uint64 framesRead;
-	ma_decoder_read_pcm_frames(&pEngine->decoder, pOutput, frameCount, &framesRead);
+	pEngine->ApplyTransport();
+
+	// a seek landed: drop what was decoded before it here and in the analyzer
+	size_t framesFlushed = 0;
+	if (pEngine->playbackQueue.TakeFlush(framesFlushed)) {
+		pEngine->playbackConsumed += framesFlushed;
+		pEngine->seekPending = false;
+		pEngine->output.RequestFlush();
+	}
+	pEngine->ApplySegments();
+	const int64_t sourceBefore = static_cast<int64_t>(pEngine->sourcePosition);
+	const uint64_t consumedBefore = pEngine->playbackConsumed;
 
+	// decoding happens on the read-ahead thread, only copy from memory here;
+	// while paused or waiting for a seek play silence and leave the ring be
+	size_t framesRead = 0;
+	if (!pEngine->paused.load(std::memory_order_relaxed) && !pEngine->seekPending) {
+		framesRead = pEngine->playbackQueue.PopBulk(pOutputF32, frameCount);
+		if (framesRead < frameCount) {
+			pEngine->underrunFrames.store(pEngine->underrunFrames.load(std::memory_order_relaxed) + (frameCount - framesRead),
+				std::memory_order_relaxed);
+		}
+	}
 	if (framesRead < frameCount) {
-		ma_decoder_seek_to_pcm_frame(&pEngine->decoder, 0);
-		const ma_uint64 framesRemaining = frameCount - framesRead;
+		memset(pOutputF32 + framesRead, 0, (frameCount - framesRead) * sizeof(float));
+	}
+	pEngine->playbackConsumed += framesRead;
+	pEngine->sourcePosition += framesRead;
+
+	// a loop wrap, track change or seek landing inside this period: the
+	// frames from the jump on come from elsewhere in the source
+	PeriodMark mark{ pEngine->framesDelivered, sourceBefore, static_cast<int64_t>(framesRead),
+		static_cast<int64_t>(framesRead), 0 };
+	StreamSegment jump;
+	if (pEngine->readAhead->Segments().Peek(jump) && jump.ringPosition < pEngine->playbackConsumed)
+	{
+		mark.jumpAt = static_cast<int64_t>(jump.ringPosition - consumedBefore);
+		mark.jumpSource = static_cast<int64_t>(jump.sourceFrame);
+	}
+	pEngine->ApplySegments();
 
+	// forward exactly what is played, silence included, so the analyzer and
+	// the other readers stay aligned with the output; the ring never blocks,
+	// a reader that falls behind loses samples on its side
+	pEngine->output.Push(pOutputF32, frameCount, callbackStartNs);
 
-		//float* pNextOutputPart = pOutputF32 + (framesRead * pDevice->playback.channels);
-		float* pNextOutputPart = pOutputF32 + framesRead;
+	// this period starts playing once the device has drained what it already
+	// holds; readers derive the audible position from it
+	PlaybackClock& clock = pEngine->clockState;
+	clock.deliveredBefore = pEngine->framesDelivered;
+	clock.deliveredAfter = pEngine->framesDelivered + frameCount;
+	clock.callbackNs = callbackStartNs;
+	clock.newest = (clock.newest + 1) % clock.history;
+	clock.periods[clock.newest] = mark;
+	pEngine->framesDelivered = clock.deliveredAfter;
+	pEngine->playbackClock.Publish(clock);
 
-		ma_uint64 extraFramesRead = 0;
-		ma_decoder_read_pcm_frames(&pEngine->decoder, pNextOutputPart, framesRemaining, &extraFramesRead);
-		framesRead += extraFramesRead;
-	}
+	pEngine->deadlineMonitor.End(beginCycles, frameCount);
+}
+
+void AudioEngine::ma_capture_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
+	const uint64_t beginCycles = DeadlineMonitor::Begin();
+	const int64_t callbackStartNs = NowNanos();
+	const ScopedNoDenormals noDenormals;
+	auto* pEngine = static_cast<AudioEngine *>(pDevice->pUserData);
+	(void)pOutput;
 
-	for (ma_uint32 i{}; i < static_cast<ma_uint32>(framesRead); ++i) {
-		//const float left = pOutputF32[i * 2];
-		//const float right = pOutputF32[i * 2 + 1];
-		//const float monoSample = (left + right) * 0.5f;
-		//pEngine->circularQueue.PushBack(monoSample);
-		const float sample = pOutputF32[i];
-		pEngine->circularQueue.PushBack(sample);
+	pEngine->RecordCallbackTiming(callbackStartNs, frameCount);
+	const auto* pInputF32 = static_cast<const float*>(pInput);
+
+	pEngine->output.Push(pInputF32, frameCount, callbackStartNs);
+
+	pEngine->deadlineMonitor.End(beginCycles, frameCount);
+}
+
+void AudioEngine::RecordCallbackTiming(const int64_t callbackStartNs, const ma_uint32 frameCount)
+{
+	frameCountHistogram.Record(frameCount);
+
+	// the time since the previous callback should equal the period it filled
+	if (lastCallbackNs != 0 && device.sampleRate != 0)
+	{
+		const int64_t expectedNs = static_cast<int64_t>(lastFrameCount) * 1000000000 / device.sampleRate;
+		const int64_t intervalNs = callbackStartNs - lastCallbackNs;
+		callbackJitterHistogram.Record(static_cast<uint64_t>(std::abs(intervalNs - expectedNs)));
 	}
+	lastCallbackNs = callbackStartNs;
+	lastFrameCount = frameCount;
 }
 
-AudioEngine::AudioEngine(RingBuffer& queue, std::string& filePath)
+AudioEngine::AudioEngine(BroadcastRing& output, std::string& filePath)
 	:
+	settings(),
+	context(),
 	device(),
-	decoder(),
-	circularQueue(queue),
+	playlist(),
+	output(output),
 	filePath(std::move(filePath))
 {
 }
@@ -52,41 +130,409 @@ bool AudioEngine::isPlaying()
 	return ma_device_get_state(&this->device) == ma_device_state_started;
 }
 
+const Histogram& AudioEngine::GetFrameCountHistogram() const
+{
+	return frameCountHistogram;
+}
+
+const Histogram& AudioEngine::GetCallbackDurationHistogram() const
+{
+	return deadlineMonitor.GetCostHistogram();
+}
+
+const DeadlineMonitor& AudioEngine::GetDeadlineMonitor() const
+{
+	return deadlineMonitor;
+}
+
+const Histogram& AudioEngine::GetCallbackJitterHistogram() const
+{
+	return callbackJitterHistogram;
+}
+
+uint64_t AudioEngine::GetUnderrunFrames() const
+{
+	return underrunFrames.load(std::memory_order_relaxed);
+}
+
+int64_t AudioEngine::GetAudibleFrame() const
+{
+	PlaybackClock clock;
+	if (playbackClock.Read(clock) == 0)
+	{
+		return 0;
+	}
+	return AudibleCursor(clock);
+}
+
+int64_t AudioEngine::GetAudibleSourceFrame() const
+{
+	PlaybackClock clock;
+	if (playbackClock.Read(clock) == 0)
+	{
+		return 0;
+	}
+
+	// find the period the audible frame was delivered in, newest first
+	const int64_t cursor = AudibleCursor(clock);
+	for (size_t i = 0; i < clock.history; ++i)
+	{
+		const PeriodMark& period = clock.periods[(clock.newest + clock.history - i) % clock.history];
+		if (period.delivered <= cursor || i == clock.history - 1)
+		{
+			// frames past what the period played were pause or underrun silence
+			const int64_t offset = std::clamp<int64_t>(cursor - period.delivered, 0, period.played);
+			if (offset >= period.jumpAt)
+			{
+				return period.jumpSource + (offset - period.jumpAt);
+			}
+			return period.source + offset;
+		}
+	}
+	return 0;
+}
+
+int64_t AudioEngine::AudibleCursor(const PlaybackClock& clock) const
+{
+	// interpolate within the period, but never past what was delivered so a
+	// stalled or stopped device does not run the cursor ahead
+	const int64_t rate = device.sampleRate;
+	const int64_t elapsed = (NowNanos() - clock.callbackNs) * rate / 1000000000;
+	const int64_t cursor = std::min(clock.deliveredBefore + elapsed, clock.deliveredAfter);
+	const int64_t delay = latencyFrames + static_cast<int64_t>(settings.avOffsetMs) * rate / 1000;
+	return std::max<int64_t>(0, cursor - delay);
+}
+
+bool AudioEngine::Seek(const uint64_t frame)
+{
+	return PostTransport({ TransportCommand::Type::Seek, frame, 0 });
+}
+
+bool AudioEngine::Pause()
+{
+	if (!PostTransport({ TransportCommand::Type::Pause, 0, 0 }))
+	{
+		return false;
+	}
+	pauseRequested = true;
+	return true;
+}
+
+bool AudioEngine::Resume()
+{
+	if (!PostTransport({ TransportCommand::Type::Resume, 0, 0 }))
+	{
+		return false;
+	}
+	pauseRequested = false;
+	return true;
+}
+
+bool AudioEngine::TogglePause()
+{
+	// go by what was last requested, the callback may not have applied it yet
+	return pauseRequested ? Resume() : Pause();
+}
+
+bool AudioEngine::SetLoopRegion(const uint64_t startFrame, const uint64_t endFrame)
+{
+	return PostTransport({ TransportCommand::Type::SetLoop, startFrame, endFrame });
+}
+
+bool AudioEngine::ClearLoopRegion()
+{
+	return PostTransport({ TransportCommand::Type::ClearLoop, 0, 0 });
+}
+
+bool AudioEngine::IsPaused() const
+{
+	return paused.load(std::memory_order_relaxed);
+}
+
+bool AudioEngine::PostTransport(const TransportCommand& command)
+{
+	if (!readAhead)
+	{
+		return false;
+	}
+	return transportQueue.Push(command);
+}
+
+// Callback side: pause state is applied here, everything that moves the
+// decoder is passed on to the read-ahead thread.
+void AudioEngine::ApplyTransport()
+{
+	TransportCommand command;
+	while (transportQueue.Pop(command))
+	{
+		switch (command.type)
+		{
+		case TransportCommand::Type::Pause:
+			paused.store(true, std::memory_order_relaxed);
+			break;
+		case TransportCommand::Type::Resume:
+			paused.store(false, std::memory_order_relaxed);
+			break;
+		case TransportCommand::Type::Seek:
+			// hold playback until the flush arrives so no stale audio slips out
+			if (readAhead->PostCommand(command))
+			{
+				seekPending = true;
+			}
+			break;
+		default:
+			readAhead->PostCommand(command);
+			break;
+		}
+	}
+}
+
+// Moves the source position across the jumps the read-ahead thread reported
+// for the part of the ring consumed so far.
+void AudioEngine::ApplySegments()
+{
+	StreamSegment segment;
+	while (readAhead->Segments().Peek(segment) && segment.ringPosition <= playbackConsumed)
+	{
+		sourcePosition = segment.sourceFrame + (playbackConsumed - segment.ringPosition);
+		readAhead->Segments().Pop(segment);
+	}
+}
+
+uint32_t AudioEngine::GetLatencyFrames() const
+{
+	return latencyFrames;
+}
+
 AudioEngine::~AudioEngine()
 {
 	ma_device_uninit(&device);
-	ma_decoder_uninit(&decoder);
+	readAhead.reset();
+	playlist.Close();
+	if (contextReady)
+	{
+		ma_context_uninit(&context);
+	}
+}
+
+void AudioEngine::Configure(const Settings& newSettings)
+{
+	settings = newSettings;
 }
 
 bool AudioEngine::Start()
 {
+	if (!readAhead)
+	{
+		// capture devices have nothing to pre-decode
+		return ma_device_start(&device) == MA_SUCCESS;
+	}
+
+	readAhead->Launch();
+	if (!readAhead->WaitUntilPrimed(std::chrono::milliseconds(READ_AHEAD_MS * 4)))
+	{
+		std::cerr << "WARNING: decoder read-ahead not primed before playback" << std::endl;
+	}
 	return ma_device_start(&device) == MA_SUCCESS;
 }
 
-bool AudioEngine::Init()
+bool AudioEngine::InitDecoder(const bool loop)
 {
-	ma_decoder_config decoderConfig;
-	decoderConfig = ma_decoder_config_init(ma_format_f32, 1, 0);
+	const std::vector<std::string> tracks = settings.tracks.empty()
+		? std::vector<std::string>{ filePath }
+		: settings.tracks;
 
-	if (ma_decoder_init_file(filePath.c_str(), &decoderConfig, &decoder) != MA_SUCCESS)
+	const int64_t openStartNs = NowNanos();
+	if (!playlist.Open(tracks, settings.memoryMapping, loop))
 	{
 		std::cerr << "Error occurred initializing decoder" << std::endl;
 		return false;
 	}
 
+	std::cout << "Opened " << tracks[playlist.currentTrack()] << " via " << TrackSource::PathName(playlist.currentPath())
+		<< " in " << static_cast<double>(NowNanos() - openStartNs) * 1e-6 << " ms" << std::endl;
+	return true;
+}
+
+size_t AudioEngine::GetCurrentTrack() const
+{
+	return playlist.currentTrack();
+}
+
+bool AudioEngine::InitOffline()
+{
+	// offline runs end with the last track instead of wrapping around
+	return InitDecoder(false);
+}
+
+uint32_t AudioEngine::GetSampleRate() const
+{
+	if (settings.inputMode != InputMode::File)
+	{
+		return device.sampleRate;
+	}
+	return playlist.sampleRate();
+}
+
+bool AudioEngine::InitContext()
+{
+	if (!settings.nullBackend)
+	{
+		return true;
+	}
+
+	const ma_backend backends[] = { ma_backend_null };
+	if (ma_context_init(backends, 1, NULL, &context) != MA_SUCCESS)
+	{
+		std::cerr << "ERROR: Could not initialize null audio backend" << std::endl;
+		return false;
+	}
+	contextReady = true;
+	return true;
+}
+
+void AudioEngine::ApplyPeriodSettings(ma_device_config& deviceConfig) const
+{
+	deviceConfig.periodSizeInFrames = settings.periodSizeInFrames;
+	deviceConfig.periods = settings.periodCount;
+	deviceConfig.performanceProfile = settings.performanceProfile;
+}
+
+// Backends round or ignore period requests, so report what was granted and
+// size everything downstream from that rather than from the request.
+void AudioEngine::ReportDevice(const bool capture)
+{
+	const ma_uint32 internalPeriodSize = capture ? device.capture.internalPeriodSizeInFrames
+		: device.playback.internalPeriodSizeInFrames;
+	const ma_uint32 internalPeriods = capture ? device.capture.internalPeriods : device.playback.internalPeriods;
+	const ma_uint32 internalRate = std::max<ma_uint32>(
+		capture ? device.capture.internalSampleRate : device.playback.internalSampleRate, 1);
+	const uint32_t periodFrames = static_cast<uint32_t>(
+		static_cast<uint64_t>(internalPeriodSize) * device.sampleRate / internalRate);
+
+	// everything the device buffers ahead of the speaker, at the device rate
+	latencyFrames = periodFrames * internalPeriods;
+
+	// the audible frame is up to internalPeriods periods old, plus the one
+	// being filled and one for callbacks shorter than a period
+	const size_t history = static_cast<size_t>(internalPeriods) + 2;
+	if (history > MAX_CLOCK_HISTORY)
+	{
+		std::cerr << "WARNING: " << internalPeriods << " device periods exceed the playback clock history, "
+			<< "the audible source position will be approximate" << std::endl;
+	}
+	clockState.history = std::clamp<size_t>(history, 2, MAX_CLOCK_HISTORY);
+	clockState.newest = 0;
+
+	deadlineMonitor.Configure(device.sampleRate, settings.callbackBudget);
+
+	std::cout << "Device: " << ma_get_backend_name(device.pContext->backend)
+		<< (settings.performanceProfile == ma_performance_profile_low_latency
+			? ", low-latency profile" : ", conservative profile")
+		<< ", " << internalPeriods << " x " << internalPeriodSize << " frames at "
+		<< internalRate << " Hz (requested " << settings.periodCount << " x "
+		<< settings.periodSizeInFrames << ", 0 = default), "
+		<< latencyFrames * 1000.0 / device.sampleRate << " ms buffered" << std::endl;
+}
+
+bool AudioEngine::InitCapture()
+{
+	const bool loopback = settings.inputMode == InputMode::Loopback;
+	ma_device_config deviceConfig = ma_device_config_init(loopback ? ma_device_type_loopback : ma_device_type_capture);
+	deviceConfig.capture.format = ma_format_f32;
+	deviceConfig.capture.channels = 1;
+	deviceConfig.sampleRate = 0; // device native rate
+	ApplyPeriodSettings(deviceConfig);
+	deviceConfig.dataCallback = ma_capture_callback;
+	deviceConfig.pUserData = this;
+
+	if (ma_device_init(contextReady ? &context : NULL, &deviceConfig, &device) != MA_SUCCESS)
+	{
+		std::cerr << "ERROR: Could not initialize miniaudio " << (loopback ? "loopback" : "capture")
+			<< " device" << (loopback ? " (loopback requires WASAPI)" : "") << std::endl;
+		return false;
+	}
+
+	std::cout << "Capturing from " << device.capture.name << " at " << device.sampleRate << " Hz" << std::endl;
+	ReportDevice(true);
+	return true;
+}
+
+AudioEngine::OfflineReport AudioEngine::RunOffline(const bool simulateRealtime, const std::atomic<bool>& stopFlag)
+{
+	constexpr uint64_t CHUNK_FRAMES = 1024;
+	float chunk[CHUNK_FRAMES];
+
+	OfflineReport report;
+	report.sampleRate = playlist.sampleRate();
+	int64_t decodeNs = 0;
+	const int64_t startNs = NowNanos();
+
+	while (!stopFlag.load(std::memory_order_relaxed)) {
+		const int64_t decodeStartNs = NowNanos();
+		const uint64_t framesRead = playlist.Read(chunk, CHUNK_FRAMES);
+		decodeNs += NowNanos() - decodeStartNs;
+
+		if (framesRead == 0) {
+			break;
+		}
+
+		// offline there is no deadline, so wait for the slowest reader instead
+		// of lapping it
+		const size_t needed = static_cast<size_t>(framesRead);
+		while (BroadcastRing::BUFFER_SIZE - output.GetBacklog() <= needed) {
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+
+		output.Push(chunk, static_cast<size_t>(framesRead), NowNanos());
+		report.frames += framesRead;
+
+		if (simulateRealtime) {
+			const auto dueNs = static_cast<int64_t>(report.frames * 1000000000ull / report.sampleRate);
+			std::this_thread::sleep_for(std::chrono::nanoseconds(startNs + dueNs - NowNanos()));
+		}
+	}
+
+	report.wallSeconds = static_cast<double>(NowNanos() - startNs) * 1e-9;
+	report.decodeSeconds = static_cast<double>(decodeNs) * 1e-9;
+	report.audioSeconds = static_cast<double>(report.frames) / report.sampleRate;
+	return report;
+}
+
+bool AudioEngine::Init()
+{
+	if (!InitContext())
+	{
+		return false;
+	}
+	if (settings.inputMode != InputMode::File)
+	{
+		return InitCapture();
+	}
+	if (!InitDecoder(true))
+	{
+		return false;
+	}
+
 	ma_device_config deviceConfig = ma_device_config_init(ma_device_type_playback);
-	deviceConfig.playback.format = decoder.outputFormat;
-	deviceConfig.playback.channels = decoder.outputChannels;
-	deviceConfig.sampleRate = decoder.outputSampleRate;
+	deviceConfig.playback.format = ma_format_f32;
+	deviceConfig.playback.channels = 1;
+	deviceConfig.sampleRate = playlist.sampleRate();
+	ApplyPeriodSettings(deviceConfig);
 	deviceConfig.dataCallback = ma_data_callback;
 	deviceConfig.pUserData = this;
 
-	if (ma_device_init(NULL, &deviceConfig, &device) != MA_SUCCESS)
+	if (ma_device_init(contextReady ? &context : NULL, &deviceConfig, &device) != MA_SUCCESS)
 	{
 		std::cerr << "ERROR: Could not initialize miniaudio device" << std::endl;
-		ma_decoder_uninit(&decoder);
+		playlist.Close();
 		return false;
 	}
 
+	ReportDevice(false);
+
+	const size_t readAheadFrames = static_cast<size_t>(playlist.sampleRate()) * READ_AHEAD_MS / 1000;
+	readAhead = std::make_unique<ReadAheadThread>(playlist, playbackQueue, readAheadFrames);
+	readAhead->SetTuning(settings.readAheadTuning);
 	return true;
 }
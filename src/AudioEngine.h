@@ -1,34 +1,199 @@
 #ifndef AUDIO_ENGINE_H
 #define AUDIO_ENGINE_H
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "miniaudio.h"
+#include "BroadcastRing.h"
+#include "CommandQueue.h"
+#include "DeadlineMonitor.h"
+#include "Histogram.h"
+#include "ReadAheadThread.h"
 #include "RingBuffer.h"
+#include "Playlist.h"
+#include "SnapshotChannel.h"
+#include "ThreadTuning.h"
+#include "Transport.h"
 
 
 
 class AudioEngine
 {
 public:
-	AudioEngine(RingBuffer& queue, std::string& filePath);
+	enum class InputMode
+	{
+		File,     // decode filePath and play it
+		Capture,  // analyze the default capture device (line-in, mic)
+		Loopback  // analyze what the system is playing (WASAPI only)
+	};
+
+	struct Settings
+	{
+		InputMode inputMode{ InputMode::File };
+		// map WAV files and read them directly instead of decoding them
+		// through the prefetch reader
+		bool memoryMapping{ true };
+		// use miniaudio's null backend, e.g. on headless machines
+		bool nullBackend{ false };
+		// play these files gaplessly instead of looping filePath
+		std::vector<std::string> tracks;
+		// extra delay applied to the audible cursor for latency the device
+		// does not report (DAC, Bluetooth); negative moves visuals earlier
+		int32_t avOffsetMs{ 0 };
+		// device buffering; 0 keeps the backend's default for the profile
+		uint32_t periodSizeInFrames{ 0 };
+		uint32_t periodCount{ 0 };
+		ma_performance_profile performanceProfile{ ma_performance_profile_low_latency };
+		// fraction of a period a callback may take before it counts as
+		// over budget
+		double callbackBudget{ DeadlineMonitor::DEFAULT_BUDGET };
+		// affinity and scheduling of the decoder read-ahead thread
+		ThreadTuning::Settings readAheadTuning;
+	};
+
+	struct OfflineReport
+	{
+		uint64_t frames{ 0 };
+		uint32_t sampleRate{ 0 };
+		double audioSeconds{ 0.0 };
+		double decodeSeconds{ 0.0 };
+		double wallSeconds{ 0.0 };
+	};
+
+	// everything played or captured is pushed to output, one reader per
+	// consumer (analyzer, recorder, ...)
+	AudioEngine(BroadcastRing& output, std::string& filePath);
 	AudioEngine(const AudioEngine&) = delete;
 	AudioEngine(AudioEngine&&) = delete;
 	AudioEngine& operator =(const AudioEngine&) = delete;
 	AudioEngine& operator = (AudioEngine&&) = delete;
 	~AudioEngine();
 
+	void Configure(const Settings& settings);
 	bool Start();
 	bool isPlaying();
 	bool Init();
+
+	// Headless mode: decode straight into the output ring without a device,
+	// either as fast as the consumer keeps up or paced at playback speed
+	bool InitOffline();
+	OfflineReport RunOffline(bool simulateRealtime, const std::atomic<bool>& stopFlag);
+	uint32_t GetSampleRate() const;
+	size_t GetCurrentTrack() const;
+
+	// Telemetry, safe to read from any thread
+	const Histogram& GetFrameCountHistogram() const;
+	const Histogram& GetCallbackDurationHistogram() const;
+	// callback cost against the period budget, cycle-counter timed
+	const DeadlineMonitor& GetDeadlineMonitor() const;
+	// |callback interval - period it covered|, in nanoseconds
+	const Histogram& GetCallbackJitterHistogram() const;
+	uint64_t GetUnderrunFrames() const;
+
+	// Stream position that is audible right now, in frames handed to the
+	// device (underrun silence included, matching the analyzer's input):
+	// the last period's start advanced by the time since its callback, minus
+	// the device's buffering and the configured A/V offset
+	int64_t GetAudibleFrame() const;
+	// The same instant as a frame of the current track, following seeks,
+	// pauses and loop wraps
+	int64_t GetAudibleSourceFrame() const;
+	uint32_t GetLatencyFrames() const;
+
+	// Transport, from one control thread (file playback only). Commands are
+	// applied by the callback at its next period; false if the queue is full.
+	bool Seek(uint64_t frame);
+	bool Pause();
+	bool Resume();
+	bool TogglePause();
+	// loop [startFrame, endFrame) of the current track until cleared
+	bool SetLoopRegion(uint64_t startFrame, uint64_t endFrame);
+	bool ClearLoopRegion();
+	bool IsPaused() const;
 private:
+	// where a period's frames came from: the period starting at delivered
+	// plays source, source + 1, ... for its first played frames, except that
+	// from frame jumpAt on (if < played) it continues at jumpSource
+	struct PeriodMark
+	{
+		int64_t delivered{ 0 };
+		int64_t source{ 0 };
+		int64_t played{ 0 };
+		int64_t jumpAt{ 0 };
+		int64_t jumpSource{ 0 };
+	};
+
+	// room for the periods the device buffers; the history actually used is
+	// sized from the granted period count in ReportDevice()
+	constexpr static size_t MAX_CLOCK_HISTORY = 32;
+
+	// published by the playback callback once per period
+	struct PlaybackClock
+	{
+		int64_t deliveredBefore{ 0 };
+		int64_t deliveredAfter{ 0 };
+		int64_t callbackNs{ 0 };
+		std::array<PeriodMark, MAX_CLOCK_HISTORY> periods{};
+		size_t newest{ 0 };
+		size_t history{ MAX_CLOCK_HISTORY };
+	};
+
+	// how far the decoder runs ahead of the device callback
+	constexpr static unsigned READ_AHEAD_MS = 250;
+
+	Settings settings;
+	ma_context context;
+	bool contextReady{ false };
 	ma_device device;
-	ma_decoder decoder;
-	RingBuffer& circularQueue;
+	Playlist playlist;
+	BroadcastRing& output;
+	RingBuffer playbackQueue;
+	std::unique_ptr<ReadAheadThread> readAhead;
 	std::string filePath;
 
+	Histogram frameCountHistogram;
+	DeadlineMonitor deadlineMonitor;
+	Histogram callbackJitterHistogram;
+	std::atomic<uint64_t> underrunFrames{ 0 };
+
+	// callback thread only
+	int64_t framesDelivered{ 0 };
+	int64_t lastCallbackNs{ 0 };
+	ma_uint32 lastFrameCount{ 0 };
+	PlaybackClock clockState;
+	SnapshotChannel<PlaybackClock> playbackClock;
+	uint32_t latencyFrames{ 0 };
+
+	// transport: control thread -> callback
+	CommandQueue<TransportCommand, 64> transportQueue;
+	std::atomic<bool> paused{ false };
+	// control thread only
+	bool pauseRequested{ false };
+	// callback thread only
+	bool seekPending{ false };
+	uint64_t playbackConsumed{ 0 };
+	uint64_t sourcePosition{ 0 };
+
+	bool InitDecoder(bool loop);
+	bool InitContext();
+	bool InitCapture();
+	void ApplyPeriodSettings(ma_device_config& deviceConfig) const;
+	void ReportDevice(bool capture);
+	void RecordCallbackTiming(int64_t callbackStartNs, ma_uint32 frameCount);
+	bool PostTransport(const TransportCommand& command);
+	void ApplyTransport();
+	void ApplySegments();
+	int64_t AudibleCursor(const PlaybackClock& clock) const;
+
 	static void ma_data_callback(ma_device* pDevice, void* pOutput,
 		const void* pInput, ma_uint32 frameCount);
+	static void ma_capture_callback(ma_device* pDevice, void* pOutput,
+		const void* pInput, ma_uint32 frameCount);
 };
 
 #endif
\ No newline at end of file
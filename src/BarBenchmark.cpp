@@ -0,0 +1,209 @@
+#include "BarBenchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Bar.h"
+#include "BarInstances.h"
+#include "BarLayers.h"
+#include "Clock.h"
+#include "Drawable.h"
+#include "constants.h"
+
+using namespace Constants;
+using namespace CyberpunkColors;
+
+namespace {
+// Stands in for raylib: counts the rectangles and sums their parameters,
+// so two schemes drawing the same rectangles in any order agree
+struct CountingSink {
+  uint64_t calls{0};
+  uint64_t checksum{0};
+
+  void Rect(const int x, const int y, const int w, const int h,
+            const Color color) {
+    Add(x, y, w, h, color, color);
+  }
+  void GradientV(const int x, const int y, const int w, const int h,
+                 const Color top, const Color bottom) {
+    Add(x, y, w, h, top, bottom);
+  }
+
+private:
+  void Add(const int x, const int y, const int w, const int h, const Color a,
+           const Color b) {
+    ++this->calls;
+    this->checksum += static_cast<uint64_t>(x + 3 * y + 5 * w + 7 * h) +
+                      a.r + 11u * a.g + 13u * a.a + 17u * b.r + 19u * b.a;
+  }
+};
+
+struct Frame {
+  std::vector<float> smooth;
+  std::vector<float> smeared;
+  float bassShock{0.0f};
+};
+
+// The previous scheme, as GraphicsThread built it before BarInstances: one
+// type-erased Drawable per ghost, reflection and solid bar, every frame
+void SubmitDrawables(const Frame &frame, const BarInstances::Layout &layout,
+                     const std::array<Color, 256> &colorLUT,
+                     std::vector<Drawable<>> &visBars, CountingSink &sink) {
+  visBars.clear();
+  visBars.reserve(BUCKET_COUNT * 3);
+
+  const float bassShock = frame.bassShock;
+  const Color ghostColor = ColorLerp(GHOST_BASE, GHOST_DROP, bassShock);
+  const Color ghostTop = ColorAlpha(ghostColor, 0.3f);
+  const Color ghostBottom = ColorAlpha(ghostColor, 0.0f);
+  Color targetDropTop = DROP_TOP;
+  if (bassShock > 0.8f) {
+    targetDropTop =
+        ColorLerp(DROP_TOP, {255, 215, 0, 255}, (bassShock - 0.8f) * 2.0f);
+  }
+
+  CountingSink *out = &sink;
+  const int width = static_cast<int>(layout.barWidth);
+  const float stride = layout.barWidth + BAR_SPACING;
+  float currentOffset = 0.0f;
+  for (int i = 0; i < BUCKET_COUNT; ++i) {
+    const float smear = frame.smeared[i];
+    const float smooth = frame.smooth[i];
+    if (smooth <= 0.001f && smear <= 0.001f) {
+      currentOffset += stride;
+      continue;
+    }
+
+    const int colorIndex = static_cast<int>(std::min(smooth * 155.0f, 255.0f));
+    const Color normalTop = colorLUT[colorIndex];
+    const Color normalBottom = ColorAlpha(normalTop, 0.2f);
+    const int xRight = static_cast<int>(layout.halfWidth + currentOffset);
+    const int xLeft =
+        static_cast<int>(layout.halfWidth - currentOffset - layout.barWidth);
+    const int ghostH = static_cast<int>(smear * layout.heightScale);
+    const int mainH = static_cast<int>(smooth * layout.heightScale);
+    const Color top =
+        ColorLerp(normalTop, targetDropTop, std::min(bassShock, 0.6f));
+    const Color bottom =
+        ColorLerp(normalBottom, DROP_BOTTOM, bassShock * 0.3f);
+
+    auto ghostBars = [out, ghostTop, ghostBottom](const Bar &b) {
+      if (b.height() <= 2) {
+        return;
+      }
+      const Color shadow = ColorAlpha(BLACK, 0.5f);
+      out->Rect(b.xRight(), b.y(), b.width(), b.height(), shadow);
+      out->Rect(b.xLeft(), b.y(), b.width(), b.height(), shadow);
+      out->GradientV(b.xRight(), b.y(), b.width(), b.height(), ghostTop,
+                     ghostBottom);
+      out->GradientV(b.xLeft(), b.y(), b.width(), b.height(), ghostTop,
+                     ghostBottom);
+    };
+    auto reflectionBars = [out, bottom](const Bar &b) {
+      out->GradientV(b.xLeft(), b.y() + b.height() + 5, b.width(),
+                     static_cast<int>(static_cast<float>(b.height()) * 0.4f),
+                     ColorAlpha(bottom, 0.15f), ColorAlpha(BLACK, 0.0f));
+    };
+    auto solidBars = [out, top, bottom](const Bar &b) {
+      const int x0 = b.xLeft();
+      const int x1 = b.xRight();
+      const int y = b.y();
+      const int w = b.width();
+      const int h = b.height();
+      out->GradientV(x1, y, w, h, top, bottom);
+      out->GradientV(x0, y, w, h, top, bottom);
+      if (w > 3) {
+        const Color core = ColorAlpha(WHITE, 0.3f);
+        out->Rect(x1 + w / 2 - 1, y, 2, h, core);
+        out->Rect(x0 + w / 2 - 1, y, 2, h, core);
+      }
+      const Color glow = ColorAlpha(top, 0.6f);
+      out->Rect(x0, y - 2, w, 4, glow);
+      out->Rect(x1, y - 2, w, 4, glow);
+      const Color cap = ColorAlpha(WHITE, 0.9f);
+      out->Rect(x0, y, w, 2, cap);
+      out->Rect(x1, y, w, 2, cap);
+    };
+
+    if (ghostH > 0) {
+      visBars.emplace_back(
+          Bar{ghostH, width, xLeft, xRight, layout.centerY - ghostH / 2},
+          ghostBars);
+    }
+    if (mainH > 0) {
+      const int mainY = layout.centerY - mainH / 2;
+      visBars.emplace_back(Bar{mainH, width, xLeft, xRight, mainY},
+                           reflectionBars);
+      visBars.emplace_back(Bar{mainH, width, xLeft, xRight, mainY}, solidBars);
+    }
+    currentOffset += stride;
+  }
+
+  for (auto &visual : visBars) {
+    draw(visual);
+  }
+}
+} // namespace
+
+BarBenchmark::Result BarBenchmark::Run(const Settings &settings) {
+  BarInstances::Layout layout;
+  layout.centerY = settings.screenHeight / 2;
+  layout.heightScale = static_cast<float>(settings.screenHeight);
+  layout.halfWidth = static_cast<float>(settings.screenWidth) * 0.5f;
+  layout.barWidth = std::max(
+      std::floor((layout.halfWidth - BAR_SPACING * BUCKET_COUNT) /
+                 BUCKET_COUNT),
+      1.0f);
+
+  // any palette will do; the renderer's is built the same way at startup
+  std::array<Color, 256> colorLUT{};
+  for (int i = 0; i < 256; ++i) {
+    colorLUT[i] = ColorLerp(NEON_PURPLE, NEON_CYAN, i / 255.0f);
+  }
+
+  // a cycle of frames with bars at random heights, some of them silent
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> level(0.0f, 1.0f);
+  std::vector<Frame> frames(64);
+  for (Frame &frame : frames) {
+    frame.smooth.resize(BUCKET_COUNT);
+    frame.smeared.resize(BUCKET_COUNT);
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+      const float value = level(random);
+      frame.smooth[i] = value < 0.1f ? 0.0f : value * 0.8f;
+      frame.smeared[i] = std::min(frame.smooth[i] + 0.1f * level(random), 1.0f);
+    }
+    frame.bassShock = level(random);
+  }
+
+  const auto frameCount =
+      static_cast<double>(std::max<uint64_t>(settings.frames, 1));
+  Result result;
+  BarInstances bars;
+  CountingSink instanceSink;
+  int64_t startNs = NowNanos();
+  for (uint64_t i = 0; i < settings.frames; ++i) {
+    const Frame &frame = frames[i % frames.size()];
+    bars.Fill(frame.smooth, frame.smeared, frame.bassShock, layout, colorLUT);
+    DrawBarLayers(bars, instanceSink);
+  }
+  result.instancesNsPerFrame =
+      static_cast<double>(NowNanos() - startNs) / frameCount;
+  result.instanceCalls = instanceSink.calls;
+
+  std::vector<Drawable<>> visBars;
+  CountingSink drawableSink;
+  startNs = NowNanos();
+  for (uint64_t i = 0; i < settings.frames; ++i) {
+    SubmitDrawables(frames[i % frames.size()], layout, colorLUT, visBars,
+                    drawableSink);
+  }
+  result.drawablesNsPerFrame =
+      static_cast<double>(NowNanos() - startNs) / frameCount;
+  result.drawableCalls = drawableSink.calls;
+  result.sameRectangles = instanceSink.checksum == drawableSink.checksum;
+  return result;
+}
@@ -0,0 +1,41 @@
+#ifndef BAR_BENCHMARK_H
+#define BAR_BENCHMARK_H
+
+#include <cstdint>
+
+/*
+        Bar Submission Benchmark
+
+        CPU cost per frame of turning the bar states into draw calls, with
+   the draw calls replaced by a counting sink so it runs without a window.
+
+        * instances: BarInstances::Fill() and the BarLayers.h drawers, the
+   same code GraphicsThread runs, with the sink in place of raylib.
+        * drawables: the previous scheme, kept here as the reference: a
+   vector of type-erased Drawable<128> built every frame (one per ghost,
+   reflection and solid bar) and drawn through virtual calls.
+
+        Both see the same randomly moving bar heights and must issue the same
+   rectangles, compared by count and by a checksum of their parameters.
+*/
+
+class BarBenchmark {
+public:
+  struct Settings {
+    uint64_t frames{100000};
+    int screenWidth{1280};
+    int screenHeight{720};
+  };
+
+  struct Result {
+    double instancesNsPerFrame{0.0};
+    double drawablesNsPerFrame{0.0};
+    uint64_t instanceCalls{0};
+    uint64_t drawableCalls{0};
+    bool sameRectangles{false};
+  };
+
+  static Result Run(const Settings &settings);
+};
+
+#endif
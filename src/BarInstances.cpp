@@ -0,0 +1,66 @@
+#include "BarInstances.h"
+
+#include <algorithm>
+
+using namespace Constants;
+using namespace CyberpunkColors;
+
+void BarInstances::Fill(const std::vector<float> &smooth,
+                        const std::vector<float> &smeared,
+                        const float bassShock, const Layout &layout,
+                        const std::array<Color, 256> &colorLUT) {
+  const Color ghostColor = ColorLerp(GHOST_BASE, GHOST_DROP, bassShock);
+
+  this->Clear();
+  this->width = static_cast<int>(layout.barWidth);
+  this->ghostTop = ColorAlpha(ghostColor, 0.3f);
+  this->ghostBottom = ColorAlpha(ghostColor, 0.0f);
+
+  Color targetDropTop = DROP_TOP;
+  float currentOffset = 0.0f;
+  const float stride = layout.barWidth + BAR_SPACING;
+
+  if (bassShock > 0.8f) {
+    targetDropTop =
+        ColorLerp(DROP_TOP, {255, 215, 0, 255}, (bassShock - 0.8f) * 2.0f);
+  }
+
+  for (int i = 0; i < BUCKET_COUNT; ++i) {
+    const float smear = smeared[i];
+    const float level = smooth[i];
+
+    if (level <= 0.001f && smear <= 0.001f) {
+      currentOffset += stride;
+      continue;
+    }
+
+    const int colorIndex = static_cast<int>(std::min(level * 155.0f, 255.0f));
+    const Color normalTop = colorLUT[colorIndex];
+    const Color normalBottom = ColorAlpha(normalTop, 0.2f);
+
+    const int xRight = static_cast<int>(layout.halfWidth + currentOffset);
+    const int xLeft =
+        static_cast<int>(layout.halfWidth - currentOffset - layout.barWidth);
+
+    const int ghostH = static_cast<int>(smear * layout.heightScale);
+    const int mainH = static_cast<int>(level * layout.heightScale);
+
+    const int ghostY = layout.centerY - (ghostH / 2);
+    const int mainY = layout.centerY - (mainH / 2);
+
+    float intensity = std::min(bassShock, 0.6f);
+    const Color finalTop = ColorLerp(normalTop, targetDropTop, intensity);
+    const Color finalBot =
+        ColorLerp(normalBottom, DROP_BOTTOM, bassShock * 0.3f);
+
+    // ghosts of 2 px or less would only show their backing
+    if (ghostH > 2) {
+      this->ghost.Push(xLeft, xRight, ghostY, ghostH);
+    }
+    if (mainH > 0) {
+      this->AddMain(xLeft, xRight, mainY, mainH, finalTop, finalBot);
+    }
+
+    currentOffset += stride;
+  }
+}
@@ -0,0 +1,84 @@
+#ifndef BAR_INSTANCES_H
+#define BAR_INSTANCES_H
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "constants.h"
+#include "raylib.h"
+
+/*
+        Bar Instances
+
+        The geometry and colors of one frame's visual bars, as parallel
+   arrays per layer, kept by the renderer and refilled every frame. Each bar
+   is drawn mirrored at xLeft and xRight.
+
+        * ghost: the slow-falling smeared bars, all in one color per frame.
+        * main: the live bars; their reflections are drawn from the same
+   entries.
+        * Layers are drawn one after another (see BarLayers.h). The bars use
+   additive blending, so drawing by layer instead of by bar gives the same
+   image.
+        * Fill() derives every bar from the smoothed and smeared levels; the
+   renderer and BarBenchmark both call it.
+*/
+
+struct BarInstances {
+  constexpr static size_t CAPACITY = Constants::BUCKET_COUNT;
+
+  // where the bars go on screen, fixed per window size
+  struct Layout {
+    int centerY{0};
+    float heightScale{0.0f};
+    float halfWidth{0.0f};
+    float barWidth{0.0f};
+  };
+
+  struct Layer {
+    size_t count{0};
+    std::array<int, CAPACITY> xLeft{};
+    std::array<int, CAPACITY> xRight{};
+    std::array<int, CAPACITY> y{};
+    std::array<int, CAPACITY> height{};
+
+    void Push(const int left, const int right, const int top, const int h) {
+      this->xLeft[this->count] = left;
+      this->xRight[this->count] = right;
+      this->y[this->count] = top;
+      this->height[this->count] = h;
+      ++this->count;
+    }
+  };
+
+  void Clear() {
+    this->ghost.count = 0;
+    this->main.count = 0;
+  }
+
+  // Rebuilds every layer; smooth and smeared hold BUCKET_COUNT levels in
+  // 0..1, bassShock tints the bars towards the drop colors.
+  void Fill(const std::vector<float> &smooth,
+            const std::vector<float> &smeared, float bassShock,
+            const Layout &layout, const std::array<Color, 256> &colorLUT);
+
+  void AddMain(const int left, const int right, const int top, const int h,
+               const Color topColor, const Color bottomColor) {
+    this->mainTop[this->main.count] = topColor;
+    this->mainBottom[this->main.count] = bottomColor;
+    this->main.Push(left, right, top, h);
+  }
+
+  int width{0};
+
+  Layer ghost;
+  Color ghostTop{};
+  Color ghostBottom{};
+
+  Layer main;
+  std::array<Color, CAPACITY> mainTop{};
+  std::array<Color, CAPACITY> mainBottom{};
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef BAR_LAYERS_H
+#define BAR_LAYERS_H
+
+#include <cstddef>
+
+#include "BarInstances.h"
+#include "raylib.h"
+
+/*
+        Bar Layers
+
+        Draws a BarInstances frame one layer at a time: ghosts, reflections,
+   then the solid bars. Every rectangle goes through a sink with
+
+        * Rect(x, y, w, h, color)
+        * GradientV(x, y, w, h, top, bottom)
+
+   so the renderer (RaylibSink) and BarBenchmark (a counting sink) run the
+   same drawing code.
+*/
+
+struct RaylibSink {
+  void Rect(const int x, const int y, const int w, const int h,
+            const Color color) {
+    DrawRectangle(x, y, w, h, color);
+  }
+  void GradientV(const int x, const int y, const int w, const int h,
+                 const Color top, const Color bottom) {
+    DrawRectangleGradientV(x, y, w, h, top, bottom);
+  }
+};
+
+// Dark backing first so the ghost reads against the bright grid
+template <typename Sink>
+void DrawGhostLayer(const BarInstances &bars, Sink &sink) {
+  const BarInstances::Layer &layer = bars.ghost;
+  const Color shadow = ColorAlpha(BLACK, 0.5f);
+  const int w = bars.width;
+  for (size_t i = 0; i < layer.count; ++i) {
+    const int y = layer.y[i];
+    const int h = layer.height[i];
+    sink.Rect(layer.xRight[i], y, w, h, shadow);
+    sink.Rect(layer.xLeft[i], y, w, h, shadow);
+    sink.GradientV(layer.xRight[i], y, w, h, bars.ghostTop, bars.ghostBottom);
+    sink.GradientV(layer.xLeft[i], y, w, h, bars.ghostTop, bars.ghostBottom);
+  }
+}
+
+template <typename Sink>
+void DrawReflectionLayer(const BarInstances &bars, Sink &sink) {
+  const BarInstances::Layer &layer = bars.main;
+  const Color fade = ColorAlpha(BLACK, 0.0f);
+  for (size_t i = 0; i < layer.count; ++i) {
+    sink.GradientV(layer.xLeft[i], layer.y[i] + layer.height[i] + 5,
+                   bars.width,
+                   static_cast<int>(static_cast<float>(layer.height[i]) * 0.4f),
+                   ColorAlpha(bars.mainBottom[i], 0.15f), fade);
+  }
+}
+
+template <typename Sink>
+void DrawSolidLayer(const BarInstances &bars, Sink &sink) {
+  const BarInstances::Layer &layer = bars.main;
+  const Color core = ColorAlpha(WHITE, 0.3f);
+  const Color cap = ColorAlpha(WHITE, 0.9f);
+  const int w = bars.width;
+  for (size_t i = 0; i < layer.count; ++i) {
+    const int xLeft = layer.xLeft[i];
+    const int xRight = layer.xRight[i];
+    const int y = layer.y[i];
+    const int h = layer.height[i];
+    const Color top = bars.mainTop[i];
+    const Color bottom = bars.mainBottom[i];
+
+    sink.GradientV(xRight, y, w, h, top, bottom);
+    sink.GradientV(xLeft, y, w, h, top, bottom);
+
+    if (w > 3) {
+      sink.Rect(xRight + w / 2 - 1, y, 2, h, core);
+      sink.Rect(xLeft + w / 2 - 1, y, 2, h, core);
+    }
+
+    const Color glow = ColorAlpha(top, 0.6f);
+    sink.Rect(xLeft, y - 2, w, 4, glow);
+    sink.Rect(xRight, y - 2, w, 4, glow);
+
+    sink.Rect(xLeft, y, w, 2, cap);
+    sink.Rect(xRight, y, w, 2, cap);
+  }
+}
+
+template <typename Sink>
+void DrawBarLayers(const BarInstances &bars, Sink &sink) {
+  DrawGhostLayer(bars, sink);
+  DrawReflectionLayer(bars, sink);
+  DrawSolidLayer(bars, sink);
+}
+
+#endif
@@ -0,0 +1,200 @@
+#include "BatchAnalyzer.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "Clock.h"
+
+using namespace Constants;
+namespace fs = std::filesystem;
+
+namespace {
+bool IsAudioFile(const fs::path &path) {
+  std::string ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return ext == ".wav" || ext == ".mp3" || ext == ".flac";
+}
+} // namespace
+
+std::vector<BatchAnalyzer::Input>
+BatchAnalyzer::CollectInputs(const std::vector<std::string> &paths) {
+  std::vector<Input> inputs;
+  for (const std::string &path : paths) {
+    std::error_code ec;
+    if (!fs::is_directory(path, ec)) {
+      inputs.push_back({path, fs::path(path).filename().string()});
+      continue;
+    }
+
+    std::vector<Input> found;
+    for (const auto &entry : fs::recursive_directory_iterator(
+             path, fs::directory_options::skip_permission_denied, ec)) {
+      if (entry.is_regular_file(ec) && IsAudioFile(entry.path())) {
+        found.push_back({entry.path().string(),
+                         entry.path().lexically_relative(path).string()});
+      }
+    }
+    // directory order is unspecified; keep output stable between runs
+    std::sort(found.begin(), found.end(),
+              [](const Input &a, const Input &b) { return a.path < b.path; });
+    inputs.insert(inputs.end(), found.begin(), found.end());
+  }
+  return inputs;
+}
+
+std::string BatchAnalyzer::OutputPathFor(const Input &input,
+                                         const std::string &outputDir) {
+  if (outputDir.empty()) {
+    return input.path + ".features.csv";
+  }
+  return (fs::path(outputDir) / input.relative).string() + ".features.csv";
+}
+
+size_t BatchAnalyzer::CountCollisions() const {
+  std::vector<std::pair<std::string, size_t>> outputs;
+  outputs.reserve(this->results.size());
+  for (size_t i = 0; i < this->results.size(); ++i) {
+    outputs.emplace_back(
+        fs::path(this->results[i].output).lexically_normal().string(), i);
+  }
+  std::sort(outputs.begin(), outputs.end());
+
+  size_t collisions = 0;
+  for (size_t i = 1; i < outputs.size(); ++i) {
+    if (outputs[i].first != outputs[i - 1].first) {
+      continue;
+    }
+    std::cerr << this->results[outputs[i - 1].second].input << " and "
+              << this->results[outputs[i].second].input
+              << " would both write " << outputs[i].first << '\n';
+    ++collisions;
+  }
+  return collisions;
+}
+
+BatchAnalyzer::Report BatchAnalyzer::Run(const std::vector<Input> &inputs,
+                                         const Settings &settings) {
+  this->results.assign(inputs.size(), FileResult{});
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    this->results[i].input = inputs[i].path;
+    this->results[i].output = OutputPathFor(inputs[i], settings.outputDir);
+  }
+
+  // refuse up front rather than let one worker silently overwrite another
+  Report report;
+  report.files = inputs.size();
+  report.collisions = CountCollisions();
+  if (report.collisions > 0) {
+    report.failed = inputs.size();
+    return report;
+  }
+
+  if (!settings.outputDir.empty()) {
+    std::error_code ec;
+    for (const FileResult &result : this->results) {
+      fs::create_directories(fs::path(result.output).parent_path(), ec);
+    }
+  }
+
+  WorkStealingPool pool(settings.workers);
+  pool.SetTuning(settings.workerTuning);
+  std::vector<std::unique_ptr<TrackAnalyzer>> analyzers(pool.WorkerCount());
+  for (auto &analyzer : analyzers) {
+    analyzer = std::make_unique<TrackAnalyzer>();
+  }
+
+  const int64_t startNs = NowNanos();
+  pool.Run(inputs.size(), [&](const size_t task, const size_t worker) {
+    FileResult &result = this->results[task];
+    result.worker = worker;
+    const int64_t fileStartNs = NowNanos();
+    AnalyzeFile(*analyzers[worker], result, settings.analysis);
+    result.wallNs = NowNanos() - fileStartNs;
+  });
+
+  report.wallSeconds = static_cast<double>(NowNanos() - startNs) * 1e-9;
+  report.workers = pool.WorkerCount();
+  for (const WorkStealingPool::WorkerStats &stats : pool.GetStats()) {
+    report.stolen += stats.stolen;
+  }
+  for (const FileResult &result : this->results) {
+    if (!result.analysis.ok) {
+      ++report.failed;
+      continue;
+    }
+    report.audioSeconds += static_cast<double>(result.analysis.sourceFrames) /
+                           result.analysis.sourceRate;
+    report.busySeconds += static_cast<double>(result.wallNs) * 1e-9;
+  }
+  return report;
+}
+
+bool BatchAnalyzer::AnalyzeFile(TrackAnalyzer &analyzer, FileResult &result,
+                                const TrackAnalyzer::Settings &settings) {
+  std::ofstream out(result.output, std::ios::trunc);
+  if (!out) {
+    std::cerr << "Could not create " << result.output << '\n';
+    return false;
+  }
+  out << "hop,time_s,energy_db,centroid_hz,rolloff_hz,flatness,flux\n";
+
+  constexpr size_t bins = AnalysisFrame::BIN_COUNT;
+  std::array<float, bins> power{};
+  SpectrumAnalyzer::Spectrum previous{};
+  uint64_t hop = 0;
+
+  result.analysis = analyzer.Run(
+      result.input, settings,
+      [&](const SpectrumAnalyzer::Spectrum &spectrum) {
+        const double analysisRate = analyzer.AnalysisRate();
+        const double binHz = analysisRate / FFT_SIZE;
+
+        // undo the 0..1 / 60 dB normalization to get relative power
+        double total = 0.0;
+        double weighted = 0.0;
+        double logSum = 0.0;
+        double flux = 0.0;
+        for (size_t i = 0; i < bins; ++i) {
+          power[i] = std::pow(10.0f, (spectrum[i] - 1.0f) * 6.0f);
+          total += power[i];
+          weighted += power[i] * static_cast<double>(i);
+          logSum += std::log(static_cast<double>(power[i]));
+          flux += std::max(0.0f, spectrum[i] - previous[i]);
+        }
+        previous = spectrum;
+
+        double rolloffBin = 0.0;
+        double running = 0.0;
+        for (size_t i = 0; i < bins; ++i) {
+          running += power[i];
+          if (running >= 0.85 * total) {
+            rolloffBin = static_cast<double>(i);
+            break;
+          }
+        }
+
+        const double mean = total / bins;
+        const double flatness = std::exp(logSum / bins) / mean;
+        const double time =
+            static_cast<double>((hop + 1) * HOP_SIZE) / analysisRate;
+        out << hop << ',' << time << ',' << 10.0 * std::log10(total) << ','
+            << (weighted / total) * binHz << ',' << rolloffBin * binHz << ','
+            << flatness << ',' << flux << '\n';
+        ++hop;
+      });
+
+  if (!result.analysis.ok) {
+    out.close();
+    std::error_code ec;
+    fs::remove(result.output, ec);
+    std::cerr << "Failed to analyze " << result.input << '\n';
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,99 @@
+#ifndef BATCH_ANALYZER_H
+#define BATCH_ANALYZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TrackAnalyzer.h"
+#include "WorkStealingPool.h"
+
+/*
+        Batch Feature Extraction
+
+        Analyzes many files on a WorkStealingPool, one TrackAnalyzer per
+   worker, and writes FILE.features.csv for each input. Each row is one
+   analysis hop:
+
+        * energy_db: total power of the windowed frame
+        * centroid_hz / rolloff_hz: spectral centroid and 85% rolloff
+        * flatness: geometric over arithmetic mean power (0 tonal .. 1 noise)
+        * flux: summed positive change of the normalized spectrum since the
+   previous hop
+
+   The features are computed from the same normalized spectrum the
+   visualizer draws, so they line up with what is shown on screen.
+
+   With an output directory, files found under a directory argument keep
+   their path below it, so album1/01.wav and album2/01.wav stay apart. Any
+   two inputs that would still write the same file stop the run before it
+   starts.
+*/
+
+class BatchAnalyzer {
+public:
+  struct Input {
+    std::string path;
+    // where the output goes under an output directory: the path below the
+    // directory argument it was found in, or the file name
+    std::string relative;
+  };
+
+  struct Settings {
+    TrackAnalyzer::Settings analysis;
+    // empty writes the features next to each input
+    std::string outputDir;
+    size_t workers{0};
+    ThreadTuning::Settings workerTuning;
+  };
+
+  struct FileResult {
+    std::string input;
+    std::string output;
+    TrackAnalyzer::Result analysis;
+    int64_t wallNs{0};
+    size_t worker{0};
+  };
+
+  struct Report {
+    size_t files{0};
+    size_t failed{0};
+    // inputs sharing an output path with an earlier one; nothing was run
+    size_t collisions{0};
+    size_t workers{0};
+    uint64_t stolen{0};
+    double audioSeconds{0.0};
+    double busySeconds{0.0};
+    double wallSeconds{0.0};
+  };
+
+  BatchAnalyzer() = default;
+  BatchAnalyzer(const BatchAnalyzer &) = delete;
+  BatchAnalyzer(BatchAnalyzer &&) = delete;
+  BatchAnalyzer &operator=(const BatchAnalyzer &) = delete;
+  BatchAnalyzer &operator=(BatchAnalyzer &&) = delete;
+  ~BatchAnalyzer() = default;
+
+  // Expands directories (recursively) into the audio files they contain.
+  static std::vector<Input>
+  CollectInputs(const std::vector<std::string> &paths);
+
+  Report Run(const std::vector<Input> &inputs, const Settings &settings);
+  [[nodiscard]] const std::vector<FileResult> &GetResults() const {
+    return this->results;
+  }
+
+private:
+  static std::string OutputPathFor(const Input &input,
+                                   const std::string &outputDir);
+  // reports every output path claimed twice; returns the number of repeats
+  size_t CountCollisions() const;
+  static bool AnalyzeFile(TrackAnalyzer &analyzer, FileResult &result,
+                          const TrackAnalyzer::Settings &settings);
+
+  std::vector<FileResult> results;
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "BroadcastBenchmark.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "Clock.h"
+
+namespace {
+// positions are exact in a float up to 2^24
+constexpr uint64_t POSITION_MASK = (1u << 24) - 1;
+
+struct Reader {
+  const char *label;
+  BroadcastRing::LagPolicy policy;
+  bool slow;
+};
+
+void ReadUntilDone(BroadcastRing &ring, const int id, const Reader &reader,
+                   const uint32_t slowSleepUs, const std::atomic<bool> &done,
+                   uint64_t &errors) {
+  constexpr size_t READ_SIZE = 1024;
+  float block[READ_SIZE];
+  while (true) {
+    const bool finished = done.load(std::memory_order_acquire);
+    if (ring.IsLagging(id)) {
+      ring.Resync(id);
+    }
+
+    const size_t got = ring.Pop(id, block, READ_SIZE);
+    const uint64_t first = ring.GetCursor(id) - got;
+    for (size_t i = 0; i < got; ++i) {
+      if (block[i] != static_cast<float>((first + i) & POSITION_MASK)) {
+        ++errors;
+      }
+    }
+
+    if (got == 0) {
+      if (finished && !ring.IsLagging(id)) {
+        return;
+      }
+      ring.WaitForAvailable(id, READ_SIZE, std::chrono::milliseconds(5));
+    } else if (reader.slow) {
+      std::this_thread::sleep_for(std::chrono::microseconds(slowSleepUs));
+    }
+  }
+}
+} // namespace
+
+BroadcastBenchmark::Result
+BroadcastBenchmark::Run(const Settings &settings) {
+  const Reader readers[] = {
+      {"fast, skip forward", BroadcastRing::LagPolicy::SkipForward, false},
+      {"fast, mark lagging", BroadcastRing::LagPolicy::MarkLagging, false},
+      {"slow, skip forward", BroadcastRing::LagPolicy::SkipForward, true},
+      {"slow, mark lagging", BroadcastRing::LagPolicy::MarkLagging, true},
+  };
+  constexpr size_t READERS = sizeof(readers) / sizeof(readers[0]);
+
+  BroadcastRing ring;
+  int ids[READERS];
+  uint64_t errors[READERS] = {};
+  for (size_t r = 0; r < READERS; ++r) {
+    ids[r] = ring.Subscribe(readers[r].policy);
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (size_t r = 0; r < READERS; ++r) {
+    threads.emplace_back(ReadUntilDone, std::ref(ring), ids[r],
+                         std::cref(readers[r]), settings.slowSleepUs,
+                         std::cref(done), std::ref(errors[r]));
+  }
+
+  std::vector<float> block(settings.blockSize);
+  const int64_t blockNs = static_cast<int64_t>(settings.blockSize) *
+                          1000000000 / (48000 * settings.speed);
+  int64_t pushNs = 0;
+  const int64_t startNs = NowNanos();
+  for (uint64_t position = 0; position < settings.samples;
+       position += settings.blockSize) {
+    for (size_t i = 0; i < settings.blockSize; ++i) {
+      block[i] = static_cast<float>((position + i) & POSITION_MASK);
+    }
+    const int64_t pushStartNs = NowNanos();
+    ring.Push(block.data(), block.size(), pushStartNs);
+    pushNs += NowNanos() - pushStartNs;
+
+    const int64_t dueNs = startNs + static_cast<int64_t>(
+                                        position / settings.blockSize + 1) *
+                                        blockNs;
+    std::this_thread::sleep_for(std::chrono::nanoseconds(dueNs - NowNanos()));
+  }
+  done.store(true, std::memory_order_release);
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  Result result;
+  result.seconds = static_cast<double>(NowNanos() - startNs) * 1e-9;
+  result.pushNsPerSample =
+      static_cast<double>(pushNs) / static_cast<double>(settings.samples);
+  for (size_t r = 0; r < READERS; ++r) {
+    ReaderResult reader;
+    reader.label = readers[r].label;
+    reader.stats = ring.GetStats(ids[r]);
+    reader.errors = errors[r];
+    result.readers.push_back(reader);
+    ring.Unsubscribe(ids[r]);
+  }
+  return result;
+}
@@ -0,0 +1,46 @@
+#ifndef BROADCAST_BENCHMARK_H
+#define BROADCAST_BENCHMARK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "BroadcastRing.h"
+
+/*
+        Broadcast Ring Stress Test
+
+        One producer pushes callback-sized blocks, faster than real time, to
+   readers of both lag policies: some keep up, some sleep between reads
+   until they are lapped. Every sample carries its own stream position, so
+   each reader checks that what it got is exactly the stream at its cursor;
+   a torn or misplaced read shows up as an error, never as plausible audio.
+*/
+
+class BroadcastBenchmark {
+public:
+  struct Settings {
+    uint64_t samples{1u << 22};
+    size_t blockSize{256};
+    // producer pacing, as a multiple of real time at 48 kHz
+    uint32_t speed{16};
+    // the slow readers sleep this long between reads
+    uint32_t slowSleepUs{3000};
+  };
+
+  struct ReaderResult {
+    const char *label{""};
+    BroadcastRing::ConsumerStats stats;
+    uint64_t errors{0};
+  };
+
+  struct Result {
+    double pushNsPerSample{0.0};
+    double seconds{0.0};
+    std::vector<ReaderResult> readers;
+  };
+
+  static Result Run(const Settings &settings);
+};
+
+#endif
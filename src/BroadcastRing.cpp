@@ -0,0 +1,283 @@
+#include "BroadcastRing.h"
+
+#include <algorithm>
+
+int BroadcastRing::Subscribe(const LagPolicy policy) {
+  for (int id = 0; id < MAX_CONSUMERS; ++id) {
+    Consumer &consumer = this->consumers[id];
+    bool expected = false;
+    if (!consumer.active.compare_exchange_strong(expected, true,
+                                                 std::memory_order_acq_rel)) {
+      continue;
+    }
+
+    consumer.policy = policy;
+    consumer.lagging.store(false, std::memory_order_relaxed);
+    consumer.cursor.store(this->head.load(std::memory_order_acquire),
+                          std::memory_order_relaxed);
+    consumer.maxLag.store(0, std::memory_order_relaxed);
+    consumer.samplesRead.store(0, std::memory_order_relaxed);
+    consumer.samplesSkipped.store(0, std::memory_order_relaxed);
+    consumer.samplesFlushed.store(0, std::memory_order_relaxed);
+    consumer.lapCount.store(0, std::memory_order_relaxed);
+    // requests made before subscribing concern samples this reader never sees
+    consumer.flushesTaken = this->flushRequests.load(std::memory_order_acquire);
+    return id;
+  }
+  return -1;
+}
+
+void BroadcastRing::Unsubscribe(const int id) {
+  this->consumers[id].active.store(false, std::memory_order_release);
+}
+
+void BroadcastRing::Push(const float *samples, size_t count,
+                         const int64_t timeNs) {
+  // bound the in-flight claim so a lapped reader always has somewhere
+  // stable to skip to (see HandleLapped)
+  constexpr size_t maxChunk = BUFFER_SIZE / 8;
+
+  const uint64_t stampIndex =
+      this->stampsPublished.load(std::memory_order_relaxed);
+  this->stampsClaimed.store(stampIndex + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  Stamp &stamp = this->stamps[stampIndex % STAMP_COUNT];
+  stamp.start.store(this->head.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+  stamp.timeNs.store(timeNs, std::memory_order_relaxed);
+  this->stampsPublished.store(stampIndex + 1, std::memory_order_release);
+
+  while (count > 0) {
+    const size_t chunk = std::min(count, maxChunk);
+    const uint64_t start = this->head.load(std::memory_order_relaxed);
+    const uint64_t end = start + chunk;
+
+    // announce the slots about to be overwritten before touching them
+    this->claim.store(end, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < chunk; ++i) {
+      this->data[mask(start + i)].store(samples[i], std::memory_order_relaxed);
+    }
+
+    this->head.store(end, std::memory_order_release);
+    samples += chunk;
+    count -= chunk;
+  }
+
+  // only pay for a wake syscall when a reader is actually asleep
+  if (this->dataReady.HasWaiters()) {
+    this->dataReady.NotifyAll();
+  }
+}
+
+int64_t BroadcastRing::StampAt(const uint64_t position) const {
+  while (true) {
+    const uint64_t published =
+        this->stampsPublished.load(std::memory_order_acquire);
+    const uint64_t oldest =
+        published > STAMP_COUNT ? published - STAMP_COUNT : 0;
+
+    // newest first: readers ask about recent positions
+    uint64_t index = published;
+    int64_t timeNs = 0;
+    while (index > oldest) {
+      --index;
+      const Stamp &stamp = this->stamps[index % STAMP_COUNT];
+      if (stamp.start.load(std::memory_order_relaxed) <= position) {
+        timeNs = stamp.timeNs.load(std::memory_order_relaxed);
+        break;
+      }
+    }
+
+    // the oldest stamp read (index) must not have been reused meanwhile;
+    // pushes are one per period, so a retry is rare and short
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (this->stampsClaimed.load(std::memory_order_relaxed) <=
+        index + STAMP_COUNT) {
+      return timeNs;
+    }
+  }
+}
+
+void BroadcastRing::RequestFlush() {
+  this->flushMark.store(this->head.load(std::memory_order_relaxed),
+                        std::memory_order_release);
+  this->flushRequests.store(
+      this->flushRequests.load(std::memory_order_relaxed) + 1,
+      std::memory_order_release);
+}
+
+uint64_t BroadcastRing::GetSamplesPushed() const {
+  return this->head.load(std::memory_order_acquire);
+}
+
+size_t BroadcastRing::GetBacklog() const {
+  const uint64_t newest = this->head.load(std::memory_order_acquire);
+  uint64_t backlog = 0;
+  for (const Consumer &consumer : this->consumers) {
+    if (consumer.active.load(std::memory_order_acquire) &&
+        !consumer.lagging.load(std::memory_order_relaxed)) {
+      backlog = std::max(
+          backlog, newest - consumer.cursor.load(std::memory_order_relaxed));
+    }
+  }
+  return static_cast<size_t>(std::min<uint64_t>(backlog, BUFFER_SIZE));
+}
+
+size_t BroadcastRing::Pop(const int id, float *out, const size_t maxCount) {
+  Consumer &consumer = this->consumers[id];
+  if (consumer.lagging.load(std::memory_order_relaxed)) {
+    return 0;
+  }
+
+  while (true) {
+    const uint64_t newest = this->head.load(std::memory_order_acquire);
+    const uint64_t pos = consumer.cursor.load(std::memory_order_relaxed);
+    const uint64_t lag = newest - pos;
+
+    if (lag > BUFFER_SIZE) {
+      if (!HandleLapped(consumer, newest)) {
+        return 0;
+      }
+      continue;
+    }
+
+    if (lag > consumer.maxLag.load(std::memory_order_relaxed)) {
+      consumer.maxLag.store(lag, std::memory_order_relaxed);
+    }
+
+    const size_t n = static_cast<size_t>(std::min<uint64_t>(lag, maxCount));
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = this->data[mask(pos + i)].load(std::memory_order_relaxed);
+    }
+
+    // if the producer claimed any slot we just copied, the copy is torn
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t claimed = this->claim.load(std::memory_order_relaxed);
+    if (claimed > pos + BUFFER_SIZE) {
+      if (!HandleLapped(consumer,
+                        this->head.load(std::memory_order_acquire))) {
+        return 0;
+      }
+      continue;
+    }
+
+    consumer.cursor.store(pos + n, std::memory_order_relaxed);
+    bump(consumer.samplesRead, n);
+    return n;
+  }
+}
+
+size_t BroadcastRing::GetAvailable(const int id) const {
+  const uint64_t newest = this->head.load(std::memory_order_acquire);
+  const uint64_t pos =
+      this->consumers[id].cursor.load(std::memory_order_relaxed);
+  return static_cast<size_t>(std::min<uint64_t>(newest - pos, BUFFER_SIZE));
+}
+
+bool BroadcastRing::WaitForAvailable(const int id, const size_t n,
+                                     const std::chrono::nanoseconds timeout) {
+  if (GetAvailable(id) >= n) {
+    return true;
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (true) {
+    const uint32_t key = this->dataReady.PrepareWait();
+    if (GetAvailable(id) >= n) {
+      this->dataReady.CancelWait();
+      return true;
+    }
+
+    const auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::nanoseconds::zero()) {
+      this->dataReady.CancelWait();
+      return false;
+    }
+    this->dataReady.Wait(key, remaining);
+  }
+}
+
+uint64_t BroadcastRing::GetCursor(const int id) const {
+  return this->consumers[id].cursor.load(std::memory_order_relaxed);
+}
+
+bool BroadcastRing::IsLagging(const int id) const {
+  return this->consumers[id].lagging.load(std::memory_order_relaxed);
+}
+
+uint64_t BroadcastRing::Resync(const int id) {
+  Consumer &consumer = this->consumers[id];
+  const uint64_t newest = this->head.load(std::memory_order_acquire);
+  const uint64_t skipped =
+      newest - consumer.cursor.load(std::memory_order_relaxed);
+  bump(consumer.samplesSkipped, skipped);
+  consumer.cursor.store(newest, std::memory_order_relaxed);
+  consumer.lagging.store(false, std::memory_order_relaxed);
+  return skipped;
+}
+
+bool BroadcastRing::TakeFlush(const int id, size_t &discarded) {
+  discarded = 0;
+  Consumer &consumer = this->consumers[id];
+  const uint64_t requests = this->flushRequests.load(std::memory_order_acquire);
+  if (requests == consumer.flushesTaken) {
+    return false;
+  }
+  consumer.flushesTaken = requests;
+
+  const uint64_t mark = this->flushMark.load(std::memory_order_acquire);
+  const uint64_t pos = consumer.cursor.load(std::memory_order_relaxed);
+  if (mark <= pos) {
+    return true;
+  }
+  discarded = static_cast<size_t>(mark - pos);
+  bump(consumer.samplesFlushed, discarded);
+  consumer.cursor.store(mark, std::memory_order_relaxed);
+  return true;
+}
+
+BroadcastRing::ConsumerStats BroadcastRing::GetStats(const int id) const {
+  const Consumer &consumer = this->consumers[id];
+  ConsumerStats stats;
+  stats.lag = this->head.load(std::memory_order_acquire) -
+              consumer.cursor.load(std::memory_order_relaxed);
+  stats.maxLag = consumer.maxLag.load(std::memory_order_relaxed);
+  stats.samplesRead = consumer.samplesRead.load(std::memory_order_relaxed);
+  stats.samplesSkipped =
+      consumer.samplesSkipped.load(std::memory_order_relaxed);
+  stats.samplesFlushed =
+      consumer.samplesFlushed.load(std::memory_order_relaxed);
+  stats.lapCount = consumer.lapCount.load(std::memory_order_relaxed);
+  stats.lagging = consumer.lagging.load(std::memory_order_relaxed);
+  return stats;
+}
+
+// Returns true when the consumer was moved forward and may retry the read.
+bool BroadcastRing::HandleLapped(Consumer &consumer, const uint64_t newest) {
+  bump(consumer.lapCount, 1);
+
+  if (consumer.policy == LagPolicy::MarkLagging) {
+    consumer.lagging.store(true, std::memory_order_relaxed);
+    return false;
+  }
+
+  // keep a quarter of the ring so the reader lands on stable data rather
+  // than racing the producer again straight away
+  const uint64_t pos = consumer.cursor.load(std::memory_order_relaxed);
+  const uint64_t target = newest - BUFFER_SIZE / 4;
+  bump(consumer.samplesSkipped, target - pos);
+  consumer.cursor.store(target, std::memory_order_relaxed);
+  return true;
+}
+
+size_t BroadcastRing::mask(const uint64_t val) {
+  return static_cast<size_t>(val & (BUFFER_SIZE - 1));
+}
+
+void BroadcastRing::bump(std::atomic<uint64_t> &counter,
+                         const uint64_t amount) {
+  counter.store(counter.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+}
@@ -0,0 +1,143 @@
+#ifndef BROADCAST_RING_H
+#define BROADCAST_RING_H
+
+#include <__new/interference_size.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "EventCount.h"
+
+/*
+        Single-Producer Multi-Consumer Broadcast Ring
+
+        Fans one PCM stream out to several readers (analyzer, recorder,
+   network publisher) without any of them stealing samples from the others.
+
+        * The producer only advances its own head and never looks at the
+   readers, so a stalled reader can never block the audio callback.
+        * Each reader owns a cursor. A reader that falls more than
+   BUFFER_SIZE samples behind has been lapped; depending on its LagPolicy it
+   is either skipped forward to recent data or marked lagging until it calls
+   Resync().
+        * Before overwriting, the producer publishes a claim on the slots it
+   is about to write. Readers validate their copy against that claim after
+   the fact (seqlock style), so torn reads are detected and discarded.
+        * Cursors are absolute stream positions: a reader subscribed before
+   the first Push() can use its cursor as the sample position of the
+   stream, skips and flushes included.
+        * RequestFlush() marks everything pushed so far as stale; only readers
+   that call TakeFlush() drop it (the analyzer after a seek), the others
+   (a recorder) keep every sample.
+        * Each Push() carries a timestamp (the audio callback's start) that
+   StampAt() looks up by stream position for the last STAMP_COUNT pushes,
+   so a reader knows when the samples it holds were captured rather than
+   when it got around to reading them.
+*/
+
+class BroadcastRing {
+public:
+  constexpr static size_t BUFFER_SIZE = 1 << 16;
+  constexpr static int MAX_CONSUMERS = 8;
+  constexpr static size_t STAMP_COUNT = 1024;
+
+  enum class LagPolicy { SkipForward, MarkLagging };
+
+  struct ConsumerStats {
+    uint64_t lag{0};
+    uint64_t maxLag{0};
+    uint64_t samplesRead{0};
+    uint64_t samplesSkipped{0};
+    uint64_t samplesFlushed{0};
+    uint64_t lapCount{0};
+    bool lagging{false};
+  };
+
+  BroadcastRing() = default;
+  BroadcastRing(const BroadcastRing &) = delete;
+  BroadcastRing(BroadcastRing &&) = delete;
+  BroadcastRing &operator=(const BroadcastRing &) = delete;
+  BroadcastRing &operator=(BroadcastRing &&) = delete;
+  ~BroadcastRing() = default;
+
+  /* Returns a consumer id, or -1 when all slots are taken. Readers start at
+     the current head and only see samples pushed after subscribing. */
+  int Subscribe(LagPolicy policy = LagPolicy::SkipForward);
+  void Unsubscribe(int id);
+
+  /*Producer*/
+  // timeNs: when the block was captured or handed to the device
+  void Push(const float *samples, size_t count, int64_t timeNs);
+  void RequestFlush();
+  uint64_t GetSamplesPushed() const;
+  // unread samples of the slowest active reader, for producers that can
+  // afford to wait (offline decoding)
+  size_t GetBacklog() const;
+
+  /*Consumer (each id must be used by a single thread)*/
+  size_t Pop(int id, float *out, size_t maxCount);
+  size_t GetAvailable(int id) const;
+  // sleep until n samples are available or the timeout expires
+  bool WaitForAvailable(int id, size_t n, std::chrono::nanoseconds timeout);
+  // position in the stream of the next sample Pop() returns
+  uint64_t GetCursor(int id) const;
+  bool IsLagging(int id) const;
+  // jumps a lagging reader to the newest sample; returns the samples skipped
+  uint64_t Resync(int id);
+  // drops the samples pushed before the last RequestFlush(), once per
+  // request; returns whether there was a request and how much it dropped
+  bool TakeFlush(int id, size_t &discarded);
+
+  // timeNs of the push that wrote position, 0 once it has aged out of the
+  // stamp history (any thread)
+  int64_t StampAt(uint64_t position) const;
+
+  ConsumerStats GetStats(int id) const;
+
+private:
+  struct alignas(std::hardware_destructive_interference_size) Consumer {
+    std::atomic<bool> active{false};
+    std::atomic<bool> lagging{false};
+    LagPolicy policy{LagPolicy::SkipForward};
+    std::atomic<uint64_t> cursor{0};
+    std::atomic<uint64_t> maxLag{0};
+    std::atomic<uint64_t> samplesRead{0};
+    std::atomic<uint64_t> samplesSkipped{0};
+    std::atomic<uint64_t> samplesFlushed{0};
+    std::atomic<uint64_t> lapCount{0};
+    uint64_t flushesTaken{0};
+  };
+
+  struct Stamp {
+    std::atomic<uint64_t> start{0};
+    std::atomic<int64_t> timeNs{0};
+  };
+
+  bool HandleLapped(Consumer &consumer, uint64_t newest);
+  static size_t mask(uint64_t val);
+  static void bump(std::atomic<uint64_t> &counter, uint64_t amount);
+
+  /*Producer Published*/
+  alignas(std::hardware_destructive_interference_size)
+      std::atomic<uint64_t> head{0};
+  std::atomic<uint64_t> claim{0};
+  std::atomic<uint64_t> flushMark{0};
+  std::atomic<uint64_t> flushRequests{0};
+  EventCount dataReady;
+
+  // push k writes stamps[k % STAMP_COUNT]; same claim/validate scheme as
+  // the samples
+  std::atomic<uint64_t> stampsClaimed{0};
+  std::atomic<uint64_t> stampsPublished{0};
+  std::array<Stamp, STAMP_COUNT> stamps{};
+
+  alignas(std::hardware_destructive_interference_size)
+      std::array<Consumer, MAX_CONSUMERS> consumers{};
+
+  alignas(std::hardware_destructive_interference_size)
+      std::array<std::atomic<float>, BUFFER_SIZE> data{};
+};
+
+#endif
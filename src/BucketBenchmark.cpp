@@ -0,0 +1,105 @@
+#include "BucketBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Clock.h"
+
+using namespace Constants;
+
+BarBins BucketBenchmark::ReferenceRange(const int visualBar) {
+  constexpr float maxFreqCrop = 0.8f;
+  const auto rawBins = static_cast<float>(AnalysisFrame::BIN_COUNT);
+  const float numBins = rawBins * maxFreqCrop;
+
+  const auto fBar = static_cast<float>(visualBar);
+  const float tStart = fBar / BUCKET_COUNT;
+  const float tEnd = (fBar + 1.0f) / BUCKET_COUNT;
+
+  int fStart = static_cast<int>(powf(tStart, 2.5f) * numBins);
+  int fEnd = static_cast<int>(powf(tEnd, 2.5f) * numBins);
+
+  if (fStart < 2)
+    fStart = 2;
+  if (fEnd <= fStart)
+    fEnd = fStart + 1;
+  if (fEnd > static_cast<int>(numBins))
+    fEnd = static_cast<int>(numBins);
+
+  BarBins bins;
+  bins.start = static_cast<uint16_t>(fStart);
+  bins.end = static_cast<uint16_t>(std::max(fEnd, fStart));
+  return bins;
+}
+
+void BucketBenchmark::ReduceReference(
+    const SpectrumAnalyzer::Spectrum &spectrum,
+    SpectrumAnalyzer::Buckets &buckets) {
+  for (int visualBar = 0; visualBar < BUCKET_COUNT; ++visualBar) {
+    const BarBins bins = ReferenceRange(visualBar);
+
+    float sum = 0.0f;
+    int count = 0;
+    for (int q = bins.start; q < bins.end; ++q) {
+      sum += spectrum[q];
+      count++;
+    }
+
+    buckets[visualBar] = (count > 0) ? sum / static_cast<float>(count) : 0.0f;
+  }
+}
+
+BucketBenchmark::Result BucketBenchmark::Run(const Settings &settings) {
+  Result result;
+  for (int bar = 0; bar < BUCKET_COUNT; ++bar) {
+    const BarBins reference = ReferenceRange(bar);
+    const BarBins &table = SpectrumAnalyzer::BAR_BINS[bar];
+    if (reference.start != table.start || reference.end != table.end) {
+      ++result.mismatchedRanges;
+    }
+  }
+
+  // random spectra, cycled so the timing is not of one cached input
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> level(0.0f, 1.0f);
+  std::vector<SpectrumAnalyzer::Spectrum> spectra(
+      std::max<size_t>(settings.spectra, 1));
+  for (SpectrumAnalyzer::Spectrum &spectrum : spectra) {
+    for (float &bin : spectrum) {
+      bin = level(random);
+    }
+  }
+
+  SpectrumAnalyzer::Buckets table{};
+  SpectrumAnalyzer::Buckets reference{};
+  for (const SpectrumAnalyzer::Spectrum &spectrum : spectra) {
+    SpectrumAnalyzer::ReduceToBuckets(spectrum, table);
+    ReduceReference(spectrum, reference);
+    for (int bar = 0; bar < BUCKET_COUNT; ++bar) {
+      result.maxDifference = std::max(result.maxDifference,
+                                      std::fabs(table[bar] - reference[bar]));
+    }
+  }
+
+  // the checksum keeps the reductions from being optimized away
+  volatile float sink = 0.0f;
+  auto time = [&](void (*reduce)(const SpectrumAnalyzer::Spectrum &,
+                                 SpectrumAnalyzer::Buckets &)) {
+    SpectrumAnalyzer::Buckets buckets{};
+    float checksum = 0.0f;
+    const int64_t startNs = NowNanos();
+    for (uint64_t frame = 0; frame < settings.frames; ++frame) {
+      reduce(spectra[frame % spectra.size()], buckets);
+      checksum += buckets[frame % BUCKET_COUNT];
+    }
+    const auto elapsedNs = static_cast<double>(NowNanos() - startNs);
+    sink = checksum;
+    return elapsedNs / static_cast<double>(std::max<uint64_t>(settings.frames, 1));
+  };
+  result.referenceNsPerFrame = time(&ReduceReference);
+  result.tableNsPerFrame = time(&SpectrumAnalyzer::ReduceToBuckets);
+  (void)sink;
+  return result;
+}
@@ -0,0 +1,42 @@
+#ifndef BUCKET_BENCHMARK_H
+#define BUCKET_BENCHMARK_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "SpectrumAnalyzer.h"
+
+/*
+        Bucket Reduction Benchmark
+
+        Times SpectrumAnalyzer::ReduceToBuckets (compile-time bar table and
+   prefix sums) against the per-frame reference it replaced, which derived
+   every bar's bin range with two powf calls and summed the bins directly.
+   Also checks the table against the ranges the reference computes and how
+   far the bar values drift apart.
+*/
+
+class BucketBenchmark {
+public:
+  struct Settings {
+    size_t spectra{64};
+    uint64_t frames{200000};
+  };
+
+  struct Result {
+    double tableNsPerFrame{0.0};
+    double referenceNsPerFrame{0.0};
+    // bars whose bin range differs from the reference
+    int mismatchedRanges{0};
+    float maxDifference{0.0f};
+  };
+
+  static Result Run(const Settings &settings);
+
+  // the reduction as it was done per frame before BAR_BINS
+  static void ReduceReference(const SpectrumAnalyzer::Spectrum &spectrum,
+                              SpectrumAnalyzer::Buckets &buckets);
+  static BarBins ReferenceRange(int visualBar);
+};
+
+#endif
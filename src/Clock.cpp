@@ -0,0 +1,29 @@
+#include "Clock.h"
+
+#include <thread>
+
+namespace {
+double MeasureFrequency() {
+#if defined(CLOCK_TSC)
+  constexpr auto window = std::chrono::milliseconds(10);
+  const int64_t startNs = NowNanos();
+  const uint64_t startTicks = ReadCycles();
+  std::this_thread::sleep_for(window);
+  const uint64_t ticks = ReadCycles() - startTicks;
+  const int64_t elapsedNs = NowNanos() - startNs;
+  return static_cast<double>(ticks) * 1e9 / static_cast<double>(elapsedNs);
+#elif defined(__aarch64__)
+  // the generic timer reports its own fixed frequency
+  uint64_t frequency;
+  asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+  return static_cast<double>(frequency);
+#else
+  return 1e9;
+#endif
+}
+} // namespace
+
+double CycleCounterFrequency() {
+  static const double frequency = MeasureFrequency();
+  return frequency;
+}
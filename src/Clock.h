@@ -0,0 +1,44 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CLOCK_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CLOCK_TSC 1
+#endif
+
+// Monotonic timestamp shared by every pipeline stage so cross-thread
+// latencies can be computed by plain subtraction.
+inline int64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Raw CPU cycle/tick counter for timing short sections on one thread: a
+// register read with no syscall or vDSO call. Ticks are only comparable on
+// the same thread; convert with CycleCounterFrequency(). Falls back to
+// NowNanos() where there is no usable counter.
+inline uint64_t ReadCycles() {
+#if defined(CLOCK_TSC)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t ticks;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return static_cast<uint64_t>(NowNanos());
+#endif
+}
+
+// Ticks of ReadCycles() per second. The TSC rate is measured against the
+// steady clock on first use, which blocks for a few milliseconds, so call
+// this once outside any real-time thread.
+double CycleCounterFrequency();
+
+#endif
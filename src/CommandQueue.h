@@ -0,0 +1,75 @@
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <__new/interference_size.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/*
+        SPSC Command Queue
+
+        Small fixed-capacity queue of trivially copyable messages between two
+   threads, e.g. transport commands into the audio callback. Push and Pop
+   never block or allocate, so either side may be a real-time thread; a full
+   queue rejects the push instead of waiting.
+
+        CAPACITY must be a power of two; one slot is kept free to tell a full
+   queue from an empty one.
+*/
+
+template <typename T, size_t CAPACITY> class CommandQueue {
+public:
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0,
+                "capacity must be a power of two");
+  static_assert(std::is_trivially_copyable_v<T>,
+                "commands are copied in and out of the slots");
+
+  CommandQueue() = default;
+  CommandQueue(const CommandQueue &) = delete;
+  CommandQueue(CommandQueue &&) = delete;
+  CommandQueue &operator=(const CommandQueue &) = delete;
+  CommandQueue &operator=(CommandQueue &&) = delete;
+  ~CommandQueue() = default;
+
+  /*Producer*/
+  bool Push(const T &item) {
+    const size_t w = this->write.load(std::memory_order_relaxed);
+    const size_t next = (w + 1) & (CAPACITY - 1);
+    if (next == this->read.load(std::memory_order_acquire)) {
+      return false;
+    }
+    this->slots[w] = item;
+    this->write.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /*Consumer*/
+  bool Pop(T &item) {
+    if (!this->Peek(item)) {
+      return false;
+    }
+    const size_t r = this->read.load(std::memory_order_relaxed);
+    this->read.store((r + 1) & (CAPACITY - 1), std::memory_order_release);
+    return true;
+  }
+
+  bool Peek(T &item) const {
+    const size_t r = this->read.load(std::memory_order_relaxed);
+    if (r == this->write.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = this->slots[r];
+    return true;
+  }
+
+private:
+  alignas(std::hardware_destructive_interference_size)
+      std::atomic<size_t> read{0};
+  alignas(std::hardware_destructive_interference_size)
+      std::atomic<size_t> write{0};
+  std::array<T, CAPACITY> slots{};
+};
+
+#endif
@@ -0,0 +1,130 @@
+#include "ConversionBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include "Clock.h"
+
+namespace {
+void PutLE(std::vector<uint8_t> &image, const uint32_t value,
+           const size_t bytes) {
+  for (size_t i = 0; i < bytes; ++i) {
+    image.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+} // namespace
+
+const char *ConversionBenchmark::FormatName(
+    const WavReader::SampleFormat format) {
+  switch (format) {
+  case WavReader::SampleFormat::Int16:
+    return "int16";
+  case WavReader::SampleFormat::Int24:
+    return "int24";
+  case WavReader::SampleFormat::Float32:
+    return "float32";
+  default:
+    return "unsupported";
+  }
+}
+
+std::vector<uint8_t>
+ConversionBenchmark::MakeImage(const WavReader::SampleFormat format,
+                               const uint32_t channels,
+                               const uint64_t frames) {
+  const uint32_t bytes = format == WavReader::SampleFormat::Int16   ? 2
+                         : format == WavReader::SampleFormat::Int24 ? 3
+                                                                    : 4;
+  const uint32_t blockAlign = bytes * channels;
+  const auto dataSize = static_cast<uint32_t>(frames * blockAlign);
+  constexpr uint32_t sampleRate = 48000;
+
+  std::vector<uint8_t> image;
+  image.reserve(44 + dataSize);
+  image.insert(image.end(), {'R', 'I', 'F', 'F'});
+  PutLE(image, 36 + dataSize, 4);
+  image.insert(image.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+  PutLE(image, 16, 4);
+  PutLE(image, format == WavReader::SampleFormat::Float32 ? 3 : 1, 2);
+  PutLE(image, channels, 2);
+  PutLE(image, sampleRate, 4);
+  PutLE(image, sampleRate * blockAlign, 4);
+  PutLE(image, blockAlign, 2);
+  PutLE(image, bytes * 8, 2);
+  image.insert(image.end(), {'d', 'a', 't', 'a'});
+  PutLE(image, dataSize, 4);
+
+  // full-scale noise, so every bit of every sample is exercised
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+  for (uint64_t i = 0; i < frames * channels; ++i) {
+    const float value = noise(random);
+    if (format == WavReader::SampleFormat::Float32) {
+      uint32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      PutLE(image, bits, 4);
+    } else {
+      const float peak = bytes == 2 ? 32767.0f : 8388607.0f;
+      PutLE(image, static_cast<uint32_t>(std::lround(value * peak)), bytes);
+    }
+  }
+  return image;
+}
+
+double ConversionBenchmark::Time(WavReader &reader, const Settings &settings,
+                                 const uint32_t channels,
+                                 std::vector<float> &out) {
+  double best = 0.0;
+  for (int pass = 0; pass < settings.passes; ++pass) {
+    reader.SeekToFrame(0);
+    const int64_t startNs = NowNanos();
+    for (size_t offset = 0; offset < out.size();) {
+      const size_t read = reader.ReadFrames(
+          out.data() + offset, std::min(settings.chunkFrames,
+                                        out.size() - offset));
+      if (read == 0) {
+        break;
+      }
+      offset += read;
+    }
+    const auto elapsedNs = static_cast<double>(NowNanos() - startNs);
+    best = std::max(best, static_cast<double>(out.size()) * channels * 1e9 /
+                              std::max(elapsedNs, 1.0));
+  }
+  return best;
+}
+
+std::vector<ConversionBenchmark::Result>
+ConversionBenchmark::Run(const Settings &settings) {
+  std::vector<Result> results;
+  for (const auto format :
+       {WavReader::SampleFormat::Int16, WavReader::SampleFormat::Int24,
+        WavReader::SampleFormat::Float32}) {
+    for (const uint32_t channels : {1u, 2u}) {
+      const std::vector<uint8_t> image =
+          MakeImage(format, channels, settings.frames);
+      WavReader reader;
+      if (!reader.Open(image.data(), image.size())) {
+        continue;
+      }
+
+      Result result;
+      result.format = format;
+      result.channels = channels;
+      std::vector<float> simd(settings.frames);
+      std::vector<float> scalar(settings.frames);
+      reader.SetSimd(true);
+      result.simdSamplesPerSecond = Time(reader, settings, channels, simd);
+      reader.SetSimd(false);
+      result.scalarSamplesPerSecond = Time(reader, settings, channels, scalar);
+      for (size_t i = 0; i < simd.size(); ++i) {
+        result.maxDifference =
+            std::max(result.maxDifference, std::fabs(simd[i] - scalar[i]));
+      }
+      results.push_back(result);
+    }
+  }
+  return results;
+}
@@ -0,0 +1,46 @@
+#ifndef CONVERSION_BENCHMARK_H
+#define CONVERSION_BENCHMARK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "WavReader.h"
+
+/*
+        PCM Conversion Benchmark
+
+        Times WavReader's conversion to mono float for each sample format
+   and channel layout on a synthetic in-memory WAV, with the SIMD paths and
+   with the scalar loop, and checks both produce the same samples.
+*/
+
+class ConversionBenchmark {
+public:
+  struct Settings {
+    uint64_t frames{1 << 22};
+    size_t chunkFrames{4096};
+    int passes{5};
+  };
+
+  struct Result {
+    WavReader::SampleFormat format{WavReader::SampleFormat::Unsupported};
+    uint32_t channels{0};
+    // input samples (frames x channels) per second, best pass
+    double simdSamplesPerSecond{0.0};
+    double scalarSamplesPerSecond{0.0};
+    float maxDifference{0.0f};
+  };
+
+  static std::vector<Result> Run(const Settings &settings);
+  static const char *FormatName(WavReader::SampleFormat format);
+
+private:
+  static std::vector<uint8_t> MakeImage(WavReader::SampleFormat format,
+                                        uint32_t channels, uint64_t frames);
+  // best samples/s over the passes; leaves the last pass in out
+  static double Time(WavReader &reader, const Settings &settings,
+                     uint32_t channels, std::vector<float> &out);
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include "DeadlineMonitor.h"
+
+#include <algorithm>
+
+void DeadlineMonitor::Configure(const uint32_t sampleRate,
+                                const double budget) {
+  this->nanosPerCycle = 1e9 / CycleCounterFrequency();
+  this->framesPerNano = static_cast<double>(sampleRate) * 1e-9;
+  this->budgetPermille =
+      static_cast<uint32_t>(std::clamp(budget, 0.0, 1.0) * 1000.0);
+}
+
+void DeadlineMonitor::End(const uint64_t beginCycles,
+                          const uint32_t frameCount) {
+  const double costNs =
+      static_cast<double>(ReadCycles() - beginCycles) * this->nanosPerCycle;
+  this->costHistogram.Record(static_cast<uint64_t>(costNs));
+
+  // cost / period = cost * rate / frames
+  if (frameCount == 0 || this->framesPerNano == 0.0) {
+    return;
+  }
+  const auto permille = static_cast<uint32_t>(
+      costNs * this->framesPerNano * 1000.0 / frameCount);
+  this->loadHistogram.Record(permille);
+  this->lastPermille.store(permille, std::memory_order_relaxed);
+  if (permille > this->peakPermille.load(std::memory_order_relaxed)) {
+    this->peakPermille.store(permille, std::memory_order_relaxed);
+  }
+  if (permille > this->budgetPermille) {
+    bump(this->overBudget);
+  }
+  bump(this->callbacks);
+}
+
+DeadlineMonitor::Summary DeadlineMonitor::GetSummary() const {
+  Summary summary;
+  summary.callbacks = this->callbacks.load(std::memory_order_relaxed);
+  summary.overBudget = this->overBudget.load(std::memory_order_relaxed);
+  summary.lastPermille = this->lastPermille.load(std::memory_order_relaxed);
+  summary.peakPermille = this->peakPermille.load(std::memory_order_relaxed);
+  summary.budgetPermille = this->budgetPermille;
+  return summary;
+}
+
+const Histogram &DeadlineMonitor::GetCostHistogram() const {
+  return this->costHistogram;
+}
+
+const Histogram &DeadlineMonitor::GetLoadHistogram() const {
+  return this->loadHistogram;
+}
+
+// single writer (the callback), so a plain load/store is enough
+void DeadlineMonitor::bump(std::atomic<uint64_t> &counter) {
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+}
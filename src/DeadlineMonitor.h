@@ -0,0 +1,75 @@
+#ifndef DEADLINE_MONITOR_H
+#define DEADLINE_MONITOR_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "Clock.h"
+#include "Histogram.h"
+
+/*
+        Audio Callback Deadline Monitor
+
+        Times every device callback with the CPU cycle counter and relates
+   the cost to the period it had to fill: a callback that takes longer than
+   its period has already glitched, and one near it will on a busier
+   machine.
+
+        * Begin()/End() are called by the callback itself; End() only does
+   relaxed atomic updates, no allocation or locking.
+        * Load is kept in per mille of the period (Histogram records integers),
+   so 1000 means the whole period was spent in the callback.
+        * Callbacks above the budget fraction are counted as over budget.
+        * GetSummary() is a handful of relaxed loads, cheap enough to call
+   from the UI thread every frame; the histograms are for reports.
+*/
+
+class DeadlineMonitor {
+public:
+  constexpr static double DEFAULT_BUDGET = 0.5;
+
+  struct Summary {
+    uint64_t callbacks{0};
+    uint64_t overBudget{0};
+    uint32_t lastPermille{0};
+    uint32_t peakPermille{0};
+    uint32_t budgetPermille{0};
+  };
+
+  DeadlineMonitor() = default;
+  DeadlineMonitor(const DeadlineMonitor &) = delete;
+  DeadlineMonitor(DeadlineMonitor &&) = delete;
+  DeadlineMonitor &operator=(const DeadlineMonitor &) = delete;
+  DeadlineMonitor &operator=(DeadlineMonitor &&) = delete;
+  ~DeadlineMonitor() = default;
+
+  // Call before the device starts; calibrates the cycle counter.
+  void Configure(uint32_t sampleRate, double budget);
+
+  /* Callback side */
+  static uint64_t Begin() { return ReadCycles(); }
+  void End(uint64_t beginCycles, uint32_t frameCount);
+
+  /* Any thread */
+  [[nodiscard]] Summary GetSummary() const;
+  // callback cost in nanoseconds
+  [[nodiscard]] const Histogram &GetCostHistogram() const;
+  // callback cost in per mille of the period it filled
+  [[nodiscard]] const Histogram &GetLoadHistogram() const;
+
+private:
+  static void bump(std::atomic<uint64_t> &counter);
+
+  double nanosPerCycle{1.0};
+  double framesPerNano{0.0};
+  uint32_t budgetPermille{static_cast<uint32_t>(DEFAULT_BUDGET * 1000)};
+
+  Histogram costHistogram;
+  Histogram loadHistogram;
+  std::atomic<uint64_t> callbacks{0};
+  std::atomic<uint64_t> overBudget{0};
+  std::atomic<uint32_t> lastPermille{0};
+  std::atomic<uint32_t> peakPermille{0};
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include "DenormalBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "Clock.h"
+#include "Denormals.h"
+#include "Resampler.h"
+#include "SpectrumAnalyzer.h"
+
+using namespace Constants;
+
+std::vector<DenormalBenchmark::Band>
+DenormalBenchmark::Run(const Settings &settings, const bool flushDenormals) {
+  const uint64_t savedControl = Denormals::ReadControl();
+  Denormals::WriteControl(flushDenormals
+                              ? savedControl | Denormals::FLUSH_BITS
+                              : savedControl & ~Denormals::FLUSH_BITS);
+
+  Resampler resampler;
+  resampler.Configure(settings.sampleRate, settings.analysisRate);
+  auto analyzer = std::make_unique<SpectrumAnalyzer>();
+  SpectrumAnalyzer::Spectrum spectrum{};
+
+  const auto totalFrames =
+      static_cast<uint64_t>(settings.seconds * settings.sampleRate);
+  const uint64_t bandFrames = totalFrames / std::max<size_t>(settings.bands, 1);
+  // amplitude(t) = exp(-decay * t), reaching finalAmplitude at the end
+  const double decay = -std::log(settings.finalAmplitude) / settings.seconds;
+  const double phaseStep = 2.0 * 3.14159265358979323846 * settings.frequency /
+                           settings.sampleRate;
+
+  std::vector<Band> bands(settings.bands);
+  std::vector<float> input;
+  std::vector<float> pending;
+  uint64_t frame = 0;
+  while (frame < totalFrames) {
+    // time the stages the analyzer thread runs per hop, not the generator
+    int64_t hopNs = 0;
+    const uint64_t hopStart = frame;
+    while (pending.size() < HOP_SIZE) {
+      const size_t needed = resampler.InputNeeded(HOP_SIZE - pending.size());
+      input.resize(needed);
+      for (size_t i = 0; i < needed; ++i) {
+        const double t = static_cast<double>(frame + i) / settings.sampleRate;
+        input[i] = static_cast<float>(std::exp(-decay * t) *
+                                      std::sin(phaseStep * (frame + i)));
+      }
+      const int64_t startNs = NowNanos();
+      resampler.Process(input.data(), needed, pending);
+      hopNs += NowNanos() - startNs;
+      frame += needed;
+    }
+    const int64_t startNs = NowNanos();
+    analyzer->PushHop(pending.data());
+    analyzer->Compute(spectrum);
+    hopNs += NowNanos() - startNs;
+    pending.erase(pending.begin(), pending.begin() + HOP_SIZE);
+
+    Band &band =
+        bands[std::min<size_t>(hopStart / bandFrames, bands.size() - 1)];
+    if (band.hops == 0) {
+      band.startSeconds = static_cast<double>(hopStart) / settings.sampleRate;
+      band.amplitude = std::exp(-decay * band.startSeconds);
+    }
+    ++band.hops;
+    band.meanHopNs += static_cast<double>(hopNs);
+    band.maxHopNs = std::max(band.maxHopNs, static_cast<double>(hopNs));
+  }
+
+  for (Band &band : bands) {
+    if (band.hops > 0) {
+      band.meanHopNs /= static_cast<double>(band.hops);
+    }
+  }
+  Denormals::WriteControl(savedControl);
+  return bands;
+}
@@ -0,0 +1,43 @@
+#ifndef DENORMAL_BENCHMARK_H
+#define DENORMAL_BENCHMARK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+        Denormal Benchmark
+
+        Feeds a sine that decays from full scale to below the smallest
+   subnormal float through the live analysis stages (Resampler and
+   SpectrumAnalyzer) and reports the per-hop cost over time. Without
+   flush-to-zero the cost climbs once the tail reaches the subnormal range;
+   with it the cost should stay flat.
+*/
+
+class DenormalBenchmark {
+public:
+  struct Settings {
+    uint32_t sampleRate{44100};
+    uint32_t analysisRate{48000};
+    double frequency{440.0};
+    double seconds{12.0};
+    // amplitude the sine has decayed to at the end
+    double finalAmplitude{1e-46};
+    size_t bands{6};
+  };
+
+  struct Band {
+    double startSeconds{0.0};
+    double amplitude{0.0};
+    uint64_t hops{0};
+    double meanHopNs{0.0};
+    double maxHopNs{0.0};
+  };
+
+  // Runs on the calling thread with its denormal mode set as requested,
+  // restoring the previous mode afterwards.
+  static std::vector<Band> Run(const Settings &settings, bool flushDenormals);
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef DENORMALS_H
+#define DENORMALS_H
+
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86_FP)
+#include <xmmintrin.h>
+#define DENORMALS_SSE 1
+#endif
+
+/*
+        Denormal Flushing
+
+        Decaying signals (fade-outs, filter and smoothing tails, the FFT of
+   near-silence) end up in subnormal floats, which many CPUs handle in
+   microcode at tens to hundreds of times the normal cost. Flush-to-zero
+   (results) and denormals-are-zero (inputs) make those values plain zeros;
+   the error is below anything audible or visible.
+
+        The mode is per thread: x86 MXCSR FTZ|DAZ, AArch64 FPCR.FZ, 32-bit ARM
+   FPSCR.FZ. Elsewhere these are no-ops.
+
+        * DisableDenormals() at the start of a thread the pipeline owns.
+        * ScopedNoDenormals around work on a thread owned by someone else
+   (the device callback, a worker pool), restoring their mode on exit.
+*/
+
+namespace Denormals {
+#if defined(DENORMALS_SSE)
+constexpr uint64_t FLUSH_BITS = 0x8040; // FTZ | DAZ
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+constexpr uint64_t FLUSH_BITS = uint64_t{1} << 24; // FZ
+#else
+constexpr uint64_t FLUSH_BITS = 0;
+#endif
+
+inline uint64_t ReadControl() {
+#if defined(DENORMALS_SSE)
+  return _mm_getcsr();
+#elif defined(__aarch64__)
+  uint64_t fpcr;
+  asm volatile("mrs %0, fpcr" : "=r"(fpcr));
+  return fpcr;
+#elif defined(__ARM_NEON)
+  uint32_t fpscr;
+  asm volatile("vmrs %0, fpscr" : "=r"(fpscr));
+  return fpscr;
+#else
+  return 0;
+#endif
+}
+
+inline void WriteControl(const uint64_t control) {
+#if defined(DENORMALS_SSE)
+  _mm_setcsr(static_cast<unsigned int>(control));
+#elif defined(__aarch64__)
+  asm volatile("msr fpcr, %0" : : "r"(control));
+#elif defined(__ARM_NEON)
+  asm volatile("vmsr fpscr, %0" : : "r"(static_cast<uint32_t>(control)));
+#else
+  (void)control;
+#endif
+}
+} // namespace Denormals
+
+inline void DisableDenormals() {
+  Denormals::WriteControl(Denormals::ReadControl() | Denormals::FLUSH_BITS);
+}
+
+class ScopedNoDenormals {
+public:
+  ScopedNoDenormals() : saved(Denormals::ReadControl()) {
+    Denormals::WriteControl(this->saved | Denormals::FLUSH_BITS);
+  }
+  ScopedNoDenormals(const ScopedNoDenormals &) = delete;
+  ScopedNoDenormals(ScopedNoDenormals &&) = delete;
+  ScopedNoDenormals &operator=(const ScopedNoDenormals &) = delete;
+  ScopedNoDenormals &operator=(ScopedNoDenormals &&) = delete;
+  ~ScopedNoDenormals() { Denormals::WriteControl(this->saved); }
+
+private:
+  uint64_t saved;
+};
+
+#endif
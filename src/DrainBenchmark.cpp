@@ -0,0 +1,85 @@
+#include "DrainBenchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "AnalyzerThread.h"
+#include "Clock.h"
+#include "Resampler.h"
+#include "constants.h"
+
+namespace {
+constexpr size_t BLOCK_SIZE = 1024;
+
+void FillBlock(float *block, const uint64_t first, const size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    block[i] = 0.5f * std::sin(0.05f * static_cast<float>(first + i));
+  }
+}
+
+DrainBenchmark::Case RunCase(const uint32_t inputRate, const uint64_t frames,
+                             const DrainBenchmark::Settings &settings) {
+  DrainBenchmark::Case result;
+  result.inputRate = inputRate;
+  result.frames = frames;
+
+  // what the analyzer should end up with: every complete hop of the
+  // resampled stream
+  Resampler reference;
+  reference.Configure(inputRate, settings.analysisRate);
+  std::vector<float> resampled;
+  uint64_t resampledCount = 0;
+
+  BroadcastRing ring;
+  TripleBuffer<AnalysisFrame> tripleBuffer;
+  std::atomic<bool> done{false};
+  {
+    AnalyzerThread analyzer(ring, tripleBuffer, done);
+    analyzer.Configure(inputRate, settings.analysisRate);
+    analyzer.Launch();
+    if (!analyzer.IsLaunched()) {
+      return result;
+    }
+
+    float block[BLOCK_SIZE];
+    for (uint64_t pushed = 0; pushed < frames;) {
+      const size_t count =
+          static_cast<size_t>(std::min<uint64_t>(BLOCK_SIZE, frames - pushed));
+      FillBlock(block, pushed, count);
+      // hold back like the offline engine so the analyzer is never lapped
+      while (BroadcastRing::BUFFER_SIZE - ring.GetBacklog() <= count) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+      }
+      ring.Push(block, count, NowNanos());
+
+      resampled.clear();
+      reference.Process(block, count, resampled);
+      resampledCount += resampled.size();
+      pushed += count;
+    }
+
+    const int64_t startNs = NowNanos();
+    result.drained =
+        analyzer.Drain(std::chrono::milliseconds(settings.timeoutMs));
+    result.drainMs = static_cast<double>(NowNanos() - startNs) * 1e-6;
+    result.hops = analyzer.GetHopCount();
+    done.store(true);
+  }
+  result.expectedHops = resampledCount / Constants::HOP_SIZE;
+  return result;
+}
+} // namespace
+
+std::vector<DrainBenchmark::Case>
+DrainBenchmark::Run(const Settings &settings) {
+  std::vector<Case> cases;
+  for (const uint32_t inputRate : settings.inputRates) {
+    for (const uint64_t frames : settings.frames) {
+      cases.push_back(RunCase(inputRate, frames, settings));
+    }
+  }
+  return cases;
+}
@@ -0,0 +1,41 @@
+#ifndef DRAIN_BENCHMARK_H
+#define DRAIN_BENCHMARK_H
+
+#include <cstdint>
+#include <vector>
+
+/*
+        Offline Drain Check
+
+        Pushes a finite stream through the broadcast ring to a resampling
+   AnalyzerThread, as --offline does, then drains it. Each case pairs an
+   input rate with a length whose tail is not a whole hop, so the last hop
+   can need more input than HOP_SIZE. A case passes when the drain returns
+   within the timeout and the analyzer has made exactly as many hops as a
+   separate resampler fed the same input produces; the time from the last
+   push to the drain returning is reported alongside.
+*/
+
+class DrainBenchmark {
+public:
+  struct Settings {
+    std::vector<uint32_t> inputRates{44100, 48000, 96000};
+    // 290 blocks of 1024 plus a tail of 0, 600 and 1023 samples
+    std::vector<uint64_t> frames{296960, 297560, 297983};
+    uint32_t analysisRate{48000};
+    uint32_t timeoutMs{2000};
+  };
+
+  struct Case {
+    uint32_t inputRate{0};
+    uint64_t frames{0};
+    uint64_t expectedHops{0};
+    uint64_t hops{0};
+    bool drained{false};
+    double drainMs{0.0};
+  };
+
+  static std::vector<Case> Run(const Settings &settings);
+};
+
+#endif
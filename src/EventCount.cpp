@@ -0,0 +1,74 @@
+#include "EventCount.h"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <ctime>
+#endif
+
+uint32_t EventCount::PrepareWait() {
+  this->waiters.fetch_add(1, std::memory_order_seq_cst);
+  // pairs with the fence in HasWaiters(): either the producer sees this
+  // waiter, or the caller's re-check sees the producer's data
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  return this->epoch.load(std::memory_order_acquire);
+}
+
+void EventCount::CancelWait() {
+  this->waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool EventCount::HasWaiters() const {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  return this->waiters.load(std::memory_order_acquire) != 0;
+}
+
+#if defined(__linux__)
+
+bool EventCount::Wait(const uint32_t key,
+                      const std::chrono::nanoseconds timeout) {
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  timespec ts{};
+  ts.tv_sec = static_cast<time_t>(seconds.count());
+  ts.tv_nsec = static_cast<long>((timeout - seconds).count());
+
+  // returns immediately with EAGAIN if the epoch already moved on
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&this->epoch),
+          FUTEX_WAIT_PRIVATE, key, &ts, nullptr, 0);
+
+  this->waiters.fetch_sub(1, std::memory_order_relaxed);
+  return this->epoch.load(std::memory_order_acquire) != key;
+}
+
+void EventCount::NotifyAll() {
+  this->epoch.fetch_add(1, std::memory_order_release);
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&this->epoch),
+          FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+#else
+
+bool EventCount::Wait(const uint32_t key,
+                      const std::chrono::nanoseconds timeout) {
+  bool woken;
+  {
+    std::unique_lock lck(mtx);
+    woken = cv.wait_for(lck, timeout, [this, key] {
+      return this->epoch.load(std::memory_order_acquire) != key;
+    });
+  }
+  this->waiters.fetch_sub(1, std::memory_order_relaxed);
+  return woken;
+}
+
+void EventCount::NotifyAll() {
+  {
+    std::lock_guard lck(mtx);
+    this->epoch.fetch_add(1, std::memory_order_release);
+  }
+  cv.notify_all();
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef EVENT_COUNT_H
+#define EVENT_COUNT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if !defined(__linux__)
+#include <condition_variable>
+#include <mutex>
+#endif
+
+/*
+        Eventcount for Sleeping on a Lock-Free Condition
+
+        Lets a consumer block until a lock-free structure changes, without
+   adding any locking to the producer's fast path.
+
+        Consumer:
+        * key = PrepareWait()   (registers as a waiter)
+        * re-check the condition, CancelWait() if it already holds
+        * Wait(key, timeout)    (sleeps unless Notify() ran since PrepareWait)
+
+        Producer:
+        * publish data, then call HasWaiters(); only when it returns true is
+   NotifyAll() (and therefore a syscall) needed.
+
+        Linux parks waiters on a futex; other platforms fall back to a
+   condition variable, whose mutex is only touched when a waiter exists.
+*/
+
+class EventCount {
+public:
+  EventCount() = default;
+  EventCount(const EventCount &) = delete;
+  EventCount(EventCount &&) = delete;
+  EventCount &operator=(const EventCount &) = delete;
+  EventCount &operator=(EventCount &&) = delete;
+  ~EventCount() = default;
+
+  uint32_t PrepareWait();
+  void CancelWait();
+  bool Wait(uint32_t key, std::chrono::nanoseconds timeout);
+
+  bool HasWaiters() const;
+  void NotifyAll();
+
+private:
+  std::atomic<uint32_t> epoch{0};
+  std::atomic<uint32_t> waiters{0};
+
+#if !defined(__linux__)
+  std::mutex mtx;
+  std::condition_variable cv;
+#endif
+};
+
+#endif
@@ -1,6 +1,8 @@
 #include "GraphicsThread.h"
 
-#include "Bar.h"
+#include "BarLayers.h"
+#include "Clock.h"
+#include "Denormals.h"
 #include "raylib.h"
 #include "raymath.h"
 #include <sys/stat.h>
@@ -8,78 +10,11 @@
 using namespace std;
 using namespace CyberpunkColors;
 
-namespace {
-class GhostDrawer {
-public:
-  explicit GhostDrawer(const Color baseColor)
-      : mColTop(ColorAlpha(baseColor, 0.3f)),
-        mColBot(ColorAlpha(baseColor, 0.0f)),
-        mShadowCol(ColorAlpha(BLACK, 0.5f)) {}
-
-  void operator()(const Bar &bar) const {
-    if (bar.height() <= 2) {
-      return;
-    }
-
-    const int w = bar.width();
-    const int h = bar.height();
-
-    DrawRectangle(bar.xRight(), bar.y(), w, h, mShadowCol);
-    DrawRectangle(bar.xLeft(), bar.y(), w, h, mShadowCol);
-    DrawRectangleGradientV(bar.xRight(), bar.y(), w, bar.height(), mColTop,
-                           mColBot);
-    DrawRectangleGradientV(bar.xLeft(), bar.y(), w, h, mColTop, mColBot);
-  };
-
-private:
-  Color mColTop;
-  Color mColBot;
-  Color mShadowCol;
-};
-
-class SolidDrawer {
-public:
-  explicit SolidDrawer(const Color topColor, const Color bottomColor)
-      : mTopColor(topColor), mBottomColor(bottomColor),
-        mGlowColor(ColorAlpha(topColor, 0.6f)),
-        mCapColor(ColorAlpha(WHITE, 0.9f)) {}
-
-  void operator()(const Bar &bar) const {
-    if (bar.height() < 1)
-      return;
-
-    const int w = bar.width();
-    const int h = bar.height();
-
-    DrawRectangleGradientV(bar.xRight(), bar.y(), w, h, mTopColor,
-                           mBottomColor);
-    DrawRectangleGradientV(bar.xLeft(), bar.y(), w, h, mTopColor, mBottomColor);
-
-    if (w > 3) {
-      const Color core = ColorAlpha(WHITE, 0.3f);
-      DrawRectangle(bar.xRight() + w/2 -1, bar.y(), 2, h, core);
-      DrawRectangle(bar.xLeft() + w/2 -1, bar.y(), 2, h, core);
-    }
-
-    DrawRectangle(bar.xLeft(), bar.y() - 2, w, 4, mGlowColor);
-    DrawRectangle(bar.xRight(), bar.y() - 2, w, 4, mGlowColor);
-
-    DrawRectangle(bar.xLeft(), bar.y(), w, 2, mCapColor);
-    DrawRectangle(bar.xRight(), bar.y(), w, 2, mCapColor);
-  };
-
-private:
-  Color mTopColor;
-  Color mBottomColor;
-  Color mGlowColor;
-  Color mCapColor;
-};
-} // namespace
-
 GraphicsThread::GraphicsThread(const int screenHeight, const int screenWidth,
-                               TripleBuffer<std::vector<float>> &sharedBuffer)
+                               TripleBuffer<AnalysisFrame> &sharedBuffer)
     : screenHeight(screenHeight), screenWidth(screenWidth),
-      share_ag(sharedBuffer), smoothState(BUCKET_COUNT, 0.0f),
+      share_ag(sharedBuffer), history(HISTORY_FRAMES),
+      smoothState(BUCKET_COUNT, 0.0f),
       smearedState(BUCKET_COUNT, 0.0f), colorLUT(), target() {}
 
 void GraphicsThread::PrecomputeGradient() {
@@ -121,49 +56,109 @@ void GraphicsThread::Initialize() {
   this->PrecomputeGradient();
 }
 
-bool GraphicsThread::Swap() { return share_ag.swapConsumer(this->readBuffer); }
+bool GraphicsThread::Swap() {
+  if (!share_ag.swapConsumer(this->readBuffer)) {
+    ++repeatedFrames;
+    return false;
+  }
+
+  const uint64_t sequence = this->readBuffer->sequence;
+  if (lastSequence != 0 && sequence > lastSequence + 1) {
+    droppedFrames += sequence - lastSequence - 1;
+  }
+  lastSequence = sequence;
+  return true;
+}
+
+void GraphicsThread::SetPlaybackClock(std::function<int64_t()> audibleFrame,
+                                      const uint32_t sampleRate) {
+  this->audibleFrame = std::move(audibleFrame);
+  this->clockRate = sampleRate;
+}
+
+void GraphicsThread::UseCache(const SpectralCache *cache,
+                              std::function<int64_t()> sourceFrame) {
+  this->cache = cache;
+  this->cacheFrame = std::move(sourceFrame);
+}
+
+void GraphicsThread::ShowDeadlineMonitor(const DeadlineMonitor *monitor) {
+  this->deadlineMonitor = monitor;
+}
 
 void GraphicsThread::Update() {
+  if (this->cache != nullptr) {
+    // the cache is indexed by what the device is playing, so there is no
+    // analyzer frame to wait for or go stale
+    const int64_t audible = this->cacheFrame ? this->cacheFrame() : 0;
+    this->cache->Read(this->cache->FrameAt(static_cast<uint64_t>(audible)),
+                      this->barTargets);
+    this->fftProcess();
+    return;
+  }
+
   // Recycle used buffer and get fresh audio data
-  this->Swap();
-  if (!this->readBuffer || this->readBuffer->empty()) {
+  if (this->Swap() && this->readBuffer->sequence != 0) {
+    this->history[this->historyNext] = *this->readBuffer;
+    this->historyNext = (this->historyNext + 1) % HISTORY_FRAMES;
+    this->historyCount = std::min(this->historyCount + 1, HISTORY_FRAMES);
+  }
+  if (this->historyCount == 0) {
     return;
   }
+
+  const AnalysisFrame &newest =
+      this->history[(this->historyNext + HISTORY_FRAMES - 1) % HISTORY_FRAMES];
+  if (this->audibleFrame) {
+    const int64_t audible = this->audibleFrame();
+    this->shownFrame = this->SelectFrame(audible);
+
+    const float msPerFrame = 1000.0f / static_cast<float>(this->clockRate);
+    this->avLeadMs =
+        static_cast<float>(static_cast<int64_t>(newest.samplePosition) -
+                           audible) *
+        msPerFrame;
+    this->avResidualMs = static_cast<float>(static_cast<int64_t>(
+                                                this->shownFrame->samplePosition) -
+                                            audible) *
+                         msPerFrame;
+  } else {
+    this->shownFrame = &newest;
+  }
+
+  frameStalenessMs =
+      static_cast<float>(NowNanos() - this->shownFrame->producerTimeNs) *
+      1e-6f;
+  SpectrumAnalyzer::ReduceToBuckets(this->shownFrame->spectrum,
+                                    this->barTargets);
   this->fftProcess();
 }
 
+// Newest frame whose window ends at or before the audible position; the
+// oldest one when even that is still in the future.
+const AnalysisFrame *GraphicsThread::SelectFrame(const int64_t audible) const {
+  size_t index = (this->historyNext + HISTORY_FRAMES - 1) % HISTORY_FRAMES;
+  for (size_t i = 0; i < this->historyCount; ++i) {
+    const AnalysisFrame &frame = this->history[index];
+    if (static_cast<int64_t>(frame.samplePosition) <= audible ||
+        i + 1 == this->historyCount) {
+      return &frame;
+    }
+    index = (index + HISTORY_FRAMES - 1) % HISTORY_FRAMES;
+  }
+  return nullptr;
+}
+
 void GraphicsThread::fftProcess() {
-  constexpr float maxFreqCrop = 0.8f;
-  const auto rawBins = static_cast<float>(this->readBuffer->size());
-  const float numBins = rawBins * maxFreqCrop;
+  // the smoothing decays exponentially towards silent bars; scoped so the
+  // rest of the render thread keeps its floating-point mode
+  const ScopedNoDenormals noDenormals;
   const float dt = GetFrameTime();
 
   constexpr float GRAVITY = 1.2f;
 
   for (int visualBar = 0; visualBar < BUCKET_COUNT; ++visualBar) {
-    const auto fBar = static_cast<float>(visualBar);
-    const float tStart = fBar / BUCKET_COUNT;
-    const float tEnd = (fBar + 1.0f) / BUCKET_COUNT;
-
-    int fStart = static_cast<int>(powf(tStart, 2.5f) * numBins);
-    int fEnd = static_cast<int>(powf(tEnd, 2.5f) * numBins);
-
-    if (fStart < 2)
-      fStart = 2;
-    if (fEnd <= fStart)
-      fEnd = fStart + 1;
-    if (fEnd > static_cast<int>(numBins))
-      fEnd = static_cast<int>(numBins);
-
-    float sum = 0.0f;
-    int count = 0;
-
-    for (int q = fStart; q < fEnd; ++q) {
-      sum += (*readBuffer)[q];
-      count++;
-    }
-
-    const float val = (count > 0) ? sum / static_cast<float>(count) : 0.0f;
+    const float val = barTargets[visualBar];
 
     smoothState[visualBar] += (val - smoothState[visualBar]) * SMOOTHNESS * dt;
 
@@ -182,9 +177,6 @@ void GraphicsThread::fftProcess() {
 GraphicsThread::~GraphicsThread() { UnloadRenderTexture(target); }
 
 void GraphicsThread::prepareVisuals() {
-  const int centerY = screenHeight / 2;
-  const auto heightScale = static_cast<float>(this->screenHeight);
-
   const int size = static_cast<int>(smoothState.size());
   const int maxBin = std::min(size, 20);
   const float bass = smoothState.empty() ? 0.0f : smoothState[0];
@@ -203,81 +195,13 @@ void GraphicsThread::prepareVisuals() {
   }
 
   particleGenerator.Update(bass, treble);
-  const Color ghostColor = ColorLerp(GHOST_BASE, GHOST_DROP, bassShock);
-
-  visBars.clear();
-  visBars.reserve(BUCKET_COUNT * 3);
-
-  Color targetDropTop = DROP_TOP;
-  float currentOffset = 0.0f;
-  const float stride = barWidth + BAR_SPACING;
-
-  const GhostDrawer ghostDrawer(ColorAlpha(ghostColor, 0.25f));
-
-  if (bassShock > 0.8f) {
-    targetDropTop =
-        ColorLerp(DROP_TOP, {255, 215, 0, 255}, (bassShock - 0.8f) * 2.0f);
-  }
-
-  for (int i = 0; i < BUCKET_COUNT; ++i) {
-    const float smear = smearedState[i];
-    const float smooth = smoothState[i];
-
-    if (smooth <= 0.001f && smear <= 0.001f) {
-      currentOffset += stride;
-      continue;
-    }
-
-    const int colorIndex = static_cast<int>(std::min(smooth * 155.0f, 255.0f));
-    const Color normalTop = colorLUT[colorIndex];
-    const Color normalBottom = ColorAlpha(normalTop, 0.2f);
-
-    const int xRight = static_cast<int>(halfWidth + currentOffset);
-    const int xLeft = static_cast<int>(halfWidth - currentOffset - barWidth);
-
-    const int ghostH = static_cast<int>(smear * heightScale);
-    const int mainH = static_cast<int>(smooth * heightScale);
-
-    const int ghostY = centerY - (ghostH / 2);
-    const int mainY = centerY - (mainH / 2);
-
-    float intensity = std::min(bassShock, 0.6f);
-    const Color finalTop = ColorLerp(normalTop, targetDropTop, intensity);
-    const Color finalBot =
-        ColorLerp(normalBottom, DROP_BOTTOM, bassShock * 0.3f);
-
-    auto solidBars = [=](const Bar &bar) {
-      const SolidDrawer sd(finalTop, finalBot);
-      sd(bar);
-    };
 
-    auto reflectionBars = [=](const Bar &bar) {
-      DrawRectangleGradientV(
-          bar.xLeft(), bar.y() + bar.height() + 5, bar.width(),
-          static_cast<int>(static_cast<float>(bar.height()) * 0.4f),
-          ColorAlpha(finalBot, 0.15f), ColorAlpha(BLACK, 0.0f));
-    };
-
-    auto ghostBars = [ghostDrawer](const Bar &bar) { ghostDrawer(bar); };
-
-    if (ghostH > 0) {
-      visBars.emplace_back(
-          Bar{ghostH, static_cast<int>(barWidth), xLeft, xRight, ghostY},
-          ghostBars);
-    }
-
-    if (mainH > 0) {
-      visBars.emplace_back(
-          Bar{mainH, static_cast<int>(barWidth), xLeft, xRight, mainY},
-          reflectionBars);
-
-      visBars.emplace_back(
-          Bar{mainH, static_cast<int>(barWidth), xLeft, xRight, mainY},
-          solidBars);
-    }
-
-    currentOffset += stride;
-  }
+  BarInstances::Layout layout;
+  layout.centerY = this->screenHeight / 2;
+  layout.heightScale = static_cast<float>(this->screenHeight);
+  layout.halfWidth = halfWidth;
+  layout.barWidth = barWidth;
+  bars.Fill(smoothState, smearedState, bassShock, layout, colorLUT);
 }
 
 void GraphicsThread::DrawGridLines() const {
@@ -389,10 +313,9 @@ void GraphicsThread::ScreenShake() {
 }
 
 void GraphicsThread::DrawVisualBars() const {
+  RaylibSink sink;
   BeginBlendMode(BLEND_ADDITIVE);
-  for (auto &visual : this->visBars) {
-    draw(visual);
-  }
+  DrawBarLayers(this->bars, sink);
   EndBlendMode();
 }
 
@@ -409,4 +332,50 @@ void GraphicsThread::Draw() {
   DrawVisualBars();
   EndTextureMode();
   this->ScreenShake();
+
+  if (this->shownFrame != nullptr) {
+    const int64_t delayNs = NowNanos() - this->shownFrame->captureTimeNs;
+    stalenessHistogram.Record(static_cast<uint64_t>(delayNs / 1000));
+  }
+  this->DrawLatencyOverlay();
+}
+
+const Histogram &GraphicsThread::GetStalenessHistogram() const {
+  return stalenessHistogram;
+}
+
+void GraphicsThread::DrawLatencyOverlay() const {
+  const Histogram::Snapshot snapshot = stalenessHistogram.GetSnapshot();
+  constexpr float usToMs = 1e-3f;
+
+  DrawText(TextFormat("capture->draw p50 %.1f ms  p99 %.1f ms  max %.1f ms",
+                      static_cast<float>(snapshot.Percentile(50.0)) * usToMs,
+                      static_cast<float>(snapshot.Percentile(99.0)) * usToMs,
+                      static_cast<float>(snapshot.max) * usToMs),
+           10, 32, 10, NEON_CYAN);
+  DrawText(TextFormat("frame age %.1f ms  dropped %llu  repeated %llu",
+                      frameStalenessMs,
+                      static_cast<unsigned long long>(droppedFrames),
+                      static_cast<unsigned long long>(repeatedFrames)),
+           10, 46, 10, NEON_CYAN);
+  if (this->audibleFrame && this->cache == nullptr) {
+    DrawText(TextFormat("A/V: analysis leads audio by %.1f ms, shown frame "
+                        "off by %.1f ms",
+                        avLeadMs, avResidualMs),
+             10, 60, 10, NEON_CYAN);
+  }
+  if (this->deadlineMonitor != nullptr) {
+    const DeadlineMonitor::Summary load = this->deadlineMonitor->GetSummary();
+    constexpr float permilleToPercent = 0.1f;
+    DrawText(TextFormat("audio callback %.1f%% of period  peak %.1f%%  "
+                        "over %u%% budget %llu/%llu",
+                        static_cast<float>(load.lastPermille) *
+                            permilleToPercent,
+                        static_cast<float>(load.peakPermille) *
+                            permilleToPercent,
+                        load.budgetPermille / 10,
+                        static_cast<unsigned long long>(load.overBudget),
+                        static_cast<unsigned long long>(load.callbacks)),
+             10, 74, 10, load.overBudget > 0 ? NEON_PINK : NEON_CYAN);
+  }
 }
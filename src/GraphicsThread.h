@@ -1,11 +1,17 @@
 #ifndef GRAPHICS_THREAD_H
 #define GRAPHICS_THREAD_H
 
-#include "Drawable.h"
+#include "AnalysisFrame.h"
+#include "BarInstances.h"
+#include "DeadlineMonitor.h"
+#include "Histogram.h"
 #include "ParticleGenerator.h"
+#include "SpectralCache.h"
+#include "SpectrumAnalyzer.h"
 #include "TripleBuffer.h"
 #include "constants.h"
 #include "raylib.h"
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -14,7 +20,7 @@ using namespace Constants;
 class GraphicsThread {
 public:
   GraphicsThread(int screenHeight, int screenWidth,
-                 TripleBuffer<std::vector<float>> &sharedBuffer);
+                 TripleBuffer<AnalysisFrame> &sharedBuffer);
   GraphicsThread(const GraphicsThread &) = delete;
   GraphicsThread(GraphicsThread &&) = delete;
   GraphicsThread &operator=(const GraphicsThread &) = delete;
@@ -25,6 +31,24 @@ public:
   void Update();
   void Draw();
 
+  // capture-to-draw delay of every rendered frame, in microseconds
+  const Histogram &GetStalenessHistogram() const;
+
+  // Show the frame matching what is audible instead of the newest one.
+  // audibleFrame returns the stream position currently heard, in the same
+  // units as AnalysisFrame::samplePosition.
+  void SetPlaybackClock(std::function<int64_t()> audibleFrame,
+                        uint32_t sampleRate);
+
+  // Take the bars from a precomputed cache instead of from the analyzer.
+  // sourceFrame returns the frame of the track currently heard, so seeks
+  // and loops are followed.
+  void UseCache(const SpectralCache *cache,
+                std::function<int64_t()> sourceFrame);
+
+  // Show the audio callback's load against its period budget
+  void ShowDeadlineMonitor(const DeadlineMonitor *monitor);
+
 private:
   void prepareVisuals();
   void fftProcess();
@@ -32,6 +56,8 @@ private:
   void DrawGridLines() const;
   void DrawVisualBars() const;
   void ScreenShake();
+  void DrawLatencyOverlay() const;
+  const AnalysisFrame *SelectFrame(int64_t audible) const;
   void PrecomputeGradient();
 
   // Dimensions
@@ -39,11 +65,25 @@ private:
   int screenWidth{0};
 
   // Core Structures
-  TripleBuffer<std::vector<float>> &share_ag;
-  std::unique_ptr<std::vector<float>> readBuffer;
+  TripleBuffer<AnalysisFrame> &share_ag;
+  std::unique_ptr<AnalysisFrame> readBuffer;
+  SpectrumAnalyzer::Buckets barTargets{};
+  const SpectralCache *cache{nullptr};
+  std::function<int64_t()> cacheFrame;
+  const DeadlineMonitor *deadlineMonitor{nullptr};
+
+  // Recent frames, so the one matching the audible position is still around
+  // when the device's buffering makes the analyzer run ahead of the speaker
+  constexpr static size_t HISTORY_FRAMES = 64;
+  std::vector<AnalysisFrame> history;
+  size_t historyNext{0};
+  size_t historyCount{0};
+  const AnalysisFrame *shownFrame{nullptr};
+  std::function<int64_t()> audibleFrame;
+  uint32_t clockRate{0};
   std::vector<float> smoothState;
   std::vector<float> smearedState;
-  std::vector<Drawable<>> visBars;
+  BarInstances bars;
   std::array<Color, 256> colorLUT;
 
   // Scene Variables
@@ -54,6 +94,15 @@ private:
 
   // Control Variables
   float mScreenTrauma{0.0f};
+
+  // Frame Tracking
+  uint64_t lastSequence{0};
+  uint64_t droppedFrames{0};
+  uint64_t repeatedFrames{0};
+  float frameStalenessMs{0.0f};
+  float avLeadMs{0.0f};
+  float avResidualMs{0.0f};
+  Histogram stalenessHistogram;
 };
 
 #endif
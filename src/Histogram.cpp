@@ -0,0 +1,93 @@
+#include "Histogram.h"
+
+namespace {
+int Log2Floor(uint64_t value) {
+  int result = 0;
+  while (value >>= 1) {
+    ++result;
+  }
+  return result;
+}
+} // namespace
+
+int Histogram::BucketIndex(const uint64_t value) {
+  if (value < SUB_BUCKETS) {
+    return static_cast<int>(value);
+  }
+
+  const int exponent = Log2Floor(value);
+  const int shift = exponent - SUB_BUCKET_BITS;
+  const auto sub = static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+  return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t Histogram::BucketUpperBound(const int index) {
+  if (index < SUB_BUCKETS) {
+    return static_cast<uint64_t>(index);
+  }
+
+  const int shift = index / SUB_BUCKETS - 1;
+  const auto sub = static_cast<uint64_t>(index % SUB_BUCKETS);
+  const uint64_t lower = (SUB_BUCKETS + sub) << shift;
+  return lower + ((uint64_t{1} << shift) - 1);
+}
+
+void Histogram::Record(const uint64_t value) {
+  this->buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  this->count.fetch_add(1, std::memory_order_relaxed);
+  this->sum.fetch_add(value, std::memory_order_relaxed);
+
+  uint64_t currentMax = this->max.load(std::memory_order_relaxed);
+  while (value > currentMax &&
+         !this->max.compare_exchange_weak(currentMax, value,
+                                          std::memory_order_relaxed)) {
+  }
+}
+
+void Histogram::Reset() {
+  for (auto &bucket : this->buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  this->count.store(0, std::memory_order_relaxed);
+  this->sum.store(0, std::memory_order_relaxed);
+  this->max.store(0, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::GetSnapshot() const {
+  Snapshot snapshot;
+  for (int i = 0; i < BUCKET_COUNT; ++i) {
+    snapshot.buckets[i] = this->buckets[i].load(std::memory_order_relaxed);
+  }
+  snapshot.count = this->count.load(std::memory_order_relaxed);
+  snapshot.sum = this->sum.load(std::memory_order_relaxed);
+  snapshot.max = this->max.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+uint64_t Histogram::Snapshot::Percentile(const double p) const {
+  uint64_t total = 0;
+  for (const uint64_t bucket : this->buckets) {
+    total += bucket;
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  const auto rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total));
+  uint64_t seen = 0;
+  for (int i = 0; i < BUCKET_COUNT; ++i) {
+    seen += this->buckets[i];
+    if (seen > rank) {
+      const uint64_t upper = BucketUpperBound(i);
+      return upper < this->max ? upper : this->max;
+    }
+  }
+  return this->max;
+}
+
+double Histogram::Snapshot::Mean() const {
+  if (this->count == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(this->sum) / static_cast<double>(this->count);
+}
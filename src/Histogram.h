@@ -0,0 +1,60 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+        Lock-Free Log-Linear Histogram
+
+        Values are bucketed by power of two, with each octave split into
+   SUB_BUCKETS linear steps, so the relative error of a reported percentile
+   is bounded (~25%) for any magnitude from 1 to 2^64.
+
+        * Record() is lock-free and safe to call from the audio callback:
+   the counters are relaxed fetch_adds, and the max is a CAS loop that only
+   retries while another thread raises it concurrently.
+        * GetSnapshot() can be called from any thread; counters are read
+   individually, so a snapshot taken mid-record may be off by one sample.
+*/
+
+class Histogram {
+public:
+  constexpr static int SUB_BUCKET_BITS = 2;
+  constexpr static int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  constexpr static int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  struct Snapshot {
+    std::array<uint64_t, BUCKET_COUNT> buckets{};
+    uint64_t count{0};
+    uint64_t sum{0};
+    uint64_t max{0};
+
+    [[nodiscard]] uint64_t Percentile(double p) const;
+    [[nodiscard]] double Mean() const;
+  };
+
+  Histogram() = default;
+  Histogram(const Histogram &) = delete;
+  Histogram(Histogram &&) = delete;
+  Histogram &operator=(const Histogram &) = delete;
+  Histogram &operator=(Histogram &&) = delete;
+  ~Histogram() = default;
+
+  void Record(uint64_t value);
+  void Reset();
+  [[nodiscard]] Snapshot GetSnapshot() const;
+
+  static int BucketIndex(uint64_t value);
+  static uint64_t BucketUpperBound(int index);
+
+private:
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> sum{0};
+  std::atomic<uint64_t> max{0};
+};
+
+#endif
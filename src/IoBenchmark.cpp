@@ -0,0 +1,39 @@
+#include "IoBenchmark.h"
+
+#include <vector>
+
+#include "Clock.h"
+
+IoBenchmark::Result IoBenchmark::Run(const std::string &path,
+                                     const Settings &settings, const bool cold,
+                                     const Access access) {
+  Result result;
+  result.cold = cold && PrefetchReader::DropCache(path);
+
+  // opening is timed too: the decoder reads the header through the same path
+  const int64_t startNs = NowNanos();
+  TrackSource source;
+  const bool opened =
+      access == Access::Stdio
+          ? source.OpenFileDecoder(path, settings.outputSampleRate)
+          : source.Open(path, access == Access::Default,
+                        settings.outputSampleRate);
+  if (!opened) {
+    return result;
+  }
+  std::vector<float> buffer(settings.chunkFrames);
+  for (;;) {
+    const uint64_t read = source.Read(buffer.data(), buffer.size());
+    if (read == 0) {
+      break;
+    }
+    result.frames += read;
+  }
+  result.decodeNs = NowNanos() - startNs;
+
+  result.ok = true;
+  result.path = source.path();
+  result.backend = source.ioBackend();
+  result.io = source.GetIoStats();
+  return result;
+}
@@ -0,0 +1,44 @@
+#ifndef IO_BENCHMARK_H
+#define IO_BENCHMARK_H
+
+#include <cstdint>
+#include <string>
+
+#include "PrefetchReader.h"
+#include "TrackSource.h"
+
+/*
+        Decoder I/O Benchmark
+
+        Decodes a whole file through TrackSource and reports how often the
+   decoder had to wait for its bytes. Each file is decoded cold (page cache
+   dropped first, Linux only) and warm through the default path, cold with
+   mapping disabled, and cold through the stdio decoder for comparison.
+   Uncompressed WAVs take the direct mmap path by default and report no
+   prefetch stalls; without mapping they go through the prefetch reader.
+*/
+
+class IoBenchmark {
+public:
+  enum class Access { Default, NoMapping, Stdio };
+
+  struct Settings {
+    size_t chunkFrames{4096};
+    uint32_t outputSampleRate{0};
+  };
+
+  struct Result {
+    bool ok{false};
+    bool cold{false};
+    TrackSource::Path path{TrackSource::Path::None};
+    PrefetchReader::Backend backend{PrefetchReader::Backend::None};
+    uint64_t frames{0};
+    int64_t decodeNs{0};
+    PrefetchReader::Stats io;
+  };
+
+  static Result Run(const std::string &path, const Settings &settings,
+                    bool cold, Access access);
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() { this->Close(); }
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const std::string &path) {
+  this->Close();
+
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr) {
+    CloseHandle(file);
+    return false;
+  }
+
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  this->fileHandle = file;
+  this->mappingHandle = mapping;
+  this->data_ = static_cast<const uint8_t *>(view);
+  this->size_ = static_cast<size_t>(fileSize.QuadPart);
+  return true;
+}
+
+void MappedFile::Close() {
+  if (this->data_) {
+    UnmapViewOfFile(this->data_);
+    CloseHandle(this->mappingHandle);
+    CloseHandle(this->fileHandle);
+  }
+  this->data_ = nullptr;
+  this->size_ = 0;
+  this->fileHandle = nullptr;
+  this->mappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string &path) {
+  this->Close();
+
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat info {};
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    close(fd);
+    return false;
+  }
+
+  void *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                    MAP_PRIVATE, fd, 0);
+  // the mapping keeps its own reference to the file
+  close(fd);
+  if (view == MAP_FAILED) {
+    return false;
+  }
+
+  madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+  this->data_ = static_cast<const uint8_t *>(view);
+  this->size_ = static_cast<size_t>(info.st_size);
+  return true;
+}
+
+void MappedFile::Close() {
+  if (this->data_) {
+    munmap(const_cast<uint8_t *>(this->data_), this->size_);
+  }
+  this->data_ = nullptr;
+  this->size_ = 0;
+}
+
+#endif
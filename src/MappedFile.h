@@ -0,0 +1,41 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+        Read-only memory-mapped file
+
+        The whole file is mapped once and hinted for sequential access, so
+   long files are paged in by the kernel's read-ahead instead of through
+   buffered stdio reads.
+*/
+
+class MappedFile {
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile(MappedFile &&) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile &operator=(MappedFile &&) = delete;
+  ~MappedFile();
+
+  bool Open(const std::string &path);
+  void Close();
+
+  [[nodiscard]] const uint8_t *data() const { return data_; }
+  [[nodiscard]] size_t size() const { return size_; }
+  [[nodiscard]] bool isOpen() const { return data_ != nullptr; }
+
+private:
+  const uint8_t *data_{nullptr};
+  size_t size_{0};
+#if defined(_WIN32)
+  void *fileHandle{nullptr};
+  void *mappingHandle{nullptr};
+#endif
+};
+
+#endif
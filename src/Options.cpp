@@ -0,0 +1,352 @@
+#include "Options.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+// AudioEngine's playback clock covers up to 32 periods of history
+constexpr uint32_t MAX_PERIODS = 16;
+
+void PrintUsage(const char *program) {
+  std::cerr << "Usage: " << program << " [options] [file...]\n"
+            << "  --offline           analyze the file headless, as fast as "
+               "possible\n"
+            << "  --realtime          with --offline, pace decoding at "
+               "playback speed\n"
+            << "  --no-mmap           decode WAVs through the prefetch "
+               "reader instead of mapping them\n"
+            << "  --capture           visualize the default capture device "
+               "(line-in)\n"
+            << "  --loopback          visualize system output (WASAPI "
+               "loopback)\n"
+            << "  --null-backend      use miniaudio's null backend (no "
+               "hardware)\n"
+            << "  --analysis-rate HZ  resample to HZ before analysis (default "
+               "48000, 0 = input rate)\n"
+            << "  --period FRAMES     request a device period of FRAMES\n"
+            << "  --periods N         request N device periods (at most 16)\n"
+            << "  --low-latency       small device periods (128 x 2 unless "
+               "given)\n"
+            << "  --conservative      large device buffers, fewer wakeups\n"
+            << "  --av-offset MS      delay visuals by MS more (negative: "
+               "earlier)\n"
+            << "  --callback-budget P count audio callbacks over P% of the "
+               "period (default 50)\n"
+            << "  --precompute        write FILE.avsc spectral caches for the "
+               "inputs and exit\n"
+            << "  --cache-bits 8|16   quantization of --precompute (default "
+               "8)\n"
+            << "  --cache             play using FILE.avsc instead of live "
+               "analysis\n"
+            << "  --batch             write FILE.features.csv for every input "
+               "file or directory\n"
+            << "  --batch-out DIR     with --batch, write the features to DIR\n"
+            << "  --jobs N            with --batch, worker count (default: "
+               "cores)\n"
+            << "  --playlist FILE     play the files listed in FILE, one per "
+               "line\n"
+            << "  --record FILE       also write what is played or captured to "
+               "FILE (WAV)\n"
+            << "  --affinity T=CPUS   pin thread T (analyzer, reader, render, "
+               "workers) to CPUS, e.g. 2,3 or 0-3\n"
+            << "  --fifo T=PRIO       run thread T as SCHED_FIFO PRIO (Linux, "
+               "needs permission)\n"
+            << "  --nice T=N          nice level for thread T, also the "
+               "fallback for --fifo\n"
+            << "  --bench-denormals   time analysis of a decaying signal "
+               "with and without FTZ/DAZ\n"
+            << "  --bench-wav         time WAV to float conversion, SIMD vs "
+               "scalar\n"
+            << "  --bench-io          decode the inputs cold and warm, count "
+               "read stalls\n"
+            << "  --bench-buckets     time the spectrum to bar reduction\n"
+            << "  --bench-bars        time submitting the bars' draw calls\n"
+            << "  --bench-broadcast   stress the broadcast ring with fast and "
+               "lapped readers\n"
+            << "  --bench-triple-buffer  swap frames through the triple "
+               "buffer flat out, check each one\n"
+            << "  --bench-snapshot    time the snapshot channel with 1-8 "
+               "readers\n"
+            << "  --bench-drain       drain resampled tails at 44.1-96 kHz, "
+               "check every hop arrives\n"
+            << "  --help              show this message\n"
+            << "\nKeys: space pause, left/right seek 5 s, home restart, [ ] "
+               "set loop start/end, backspace clear loop\n";
+}
+
+bool ReadPlaylist(const std::string &listPath,
+                  std::vector<std::string> &tracks) {
+  std::ifstream list(listPath);
+  if (!list) {
+    std::cerr << "Could not open playlist " << listPath << '\n';
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(list, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (!line.empty() && line[0] != '#') {
+      tracks.push_back(line);
+    }
+  }
+  return true;
+}
+
+ThreadTuning::Settings *TuningFor(AppOptions &options,
+                                  const std::string &thread) {
+  if (thread == "analyzer") {
+    return &options.analyzerTuning;
+  }
+  if (thread == "reader") {
+    return &options.readAheadTuning;
+  }
+  if (thread == "render") {
+    return &options.renderTuning;
+  }
+  if (thread == "workers") {
+    return &options.workerTuning;
+  }
+  return nullptr;
+}
+
+// value is THREAD=SETTING for --affinity, --fifo and --nice
+bool ParseThreadSetting(AppOptions &options, const std::string &flag,
+                        const std::string &value) {
+  const size_t equals = value.find('=');
+  ThreadTuning::Settings *tuning =
+      equals == std::string::npos ? nullptr
+                                  : TuningFor(options, value.substr(0, equals));
+  if (tuning == nullptr) {
+    std::cerr << flag << " takes THREAD=VALUE with THREAD one of analyzer, "
+              << "reader, render, workers\n";
+    return false;
+  }
+
+  const std::string setting = value.substr(equals + 1);
+  if (flag == "--affinity") {
+    if (!ThreadTuning::ParseCpuList(setting, tuning->cpus)) {
+      std::cerr << "Invalid CPU list " << setting << '\n';
+      return false;
+    }
+    return true;
+  }
+
+  try {
+    const int level = std::stoi(setting);
+    if (flag == "--fifo" && (level < 1 || level > 99)) {
+      std::cerr << "--fifo priority must be 1..99\n";
+      return false;
+    }
+    if (flag == "--nice" && (level < -20 || level > 19)) {
+      std::cerr << "--nice level must be -20..19\n";
+      return false;
+    }
+    (flag == "--fifo" ? tuning->fifoPriority : tuning->niceLevel) = level;
+  } catch (const std::exception &) {
+    std::cerr << "Invalid " << flag << ' ' << value << '\n';
+    return false;
+  }
+  return true;
+}
+} // namespace
+
+bool ParseOptions(const int argc, char **argv, AppOptions &options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const auto nextValue = [&](std::string &value) {
+      if (i + 1 >= argc) {
+        std::cerr << arg << " needs a value\n";
+        return false;
+      }
+      value = argv[++i];
+      return true;
+    };
+
+    if (arg == "--offline") {
+      options.offline = true;
+    } else if (arg == "--realtime") {
+      options.offlineRealtime = true;
+    } else if (arg == "--no-mmap") {
+      options.memoryMapping = false;
+    } else if (arg == "--capture") {
+      options.capture = true;
+    } else if (arg == "--loopback") {
+      options.loopback = true;
+    } else if (arg == "--null-backend") {
+      options.nullBackend = true;
+    } else if (arg == "--analysis-rate") {
+      std::string value;
+      if (!nextValue(value)) {
+        return false;
+      }
+      try {
+        const unsigned long rate = std::stoul(value);
+        if (rate != 0 && (rate < 8000 || rate > 384000)) {
+          throw std::out_of_range(value);
+        }
+        options.analysisRate = static_cast<uint32_t>(rate);
+      } catch (const std::exception &) {
+        std::cerr << "Invalid --analysis-rate " << value << '\n';
+        return false;
+      }
+    } else if (arg == "--period" || arg == "--periods") {
+      std::string value;
+      if (!nextValue(value)) {
+        return false;
+      }
+      try {
+        const auto n = static_cast<uint32_t>(std::stoul(value));
+        (arg == "--period" ? options.periodSizeInFrames : options.periodCount) =
+            n;
+      } catch (const std::exception &) {
+        std::cerr << "Invalid " << arg << ' ' << value << '\n';
+        return false;
+      }
+      // the playback clock keeps a bounded history of periods
+      if (options.periodCount > MAX_PERIODS) {
+        std::cerr << "--periods must be at most " << MAX_PERIODS << '\n';
+        return false;
+      }
+    } else if (arg == "--low-latency") {
+      options.lowLatency = true;
+    } else if (arg == "--conservative") {
+      options.conservative = true;
+    } else if (arg == "--av-offset") {
+      std::string value;
+      if (!nextValue(value)) {
+        return false;
+      }
+      try {
+        options.avOffsetMs = static_cast<int32_t>(std::stol(value));
+      } catch (const std::exception &) {
+        std::cerr << "Invalid --av-offset " << value << '\n';
+        return false;
+      }
+    } else if (arg == "--callback-budget") {
+      std::string value;
+      if (!nextValue(value)) {
+        return false;
+      }
+      try {
+        options.callbackBudgetPercent =
+            static_cast<uint32_t>(std::stoul(value));
+      } catch (const std::exception &) {
+        std::cerr << "Invalid --callback-budget " << value << '\n';
+        return false;
+      }
+      if (options.callbackBudgetPercent == 0 ||
+          options.callbackBudgetPercent > 100) {
+        std::cerr << "--callback-budget must be 1..100\n";
+        return false;
+      }
+    } else if (arg == "--precompute") {
+      options.precompute = true;
+    } else if (arg == "--cache") {
+      options.useCache = true;
+    } else if (arg == "--cache-bits") {
+      std::string value;
+      if (!nextValue(value)) {
+        return false;
+      }
+      if (value != "8" && value != "16") {
+        std::cerr << "--cache-bits must be 8 or 16\n";
+        return false;
+      }
+      options.cacheBits = static_cast<uint32_t>(std::stoul(value));
+    } else if (arg == "--affinity" || arg == "--fifo" || arg == "--nice") {
+      std::string value;
+      if (!nextValue(value) || !ParseThreadSetting(options, arg, value)) {
+        return false;
+      }
+    } else if (arg == "--bench-denormals") {
+      options.benchDenormals = true;
+    } else if (arg == "--bench-wav") {
+      options.benchConversion = true;
+    } else if (arg == "--bench-io") {
+      options.benchIo = true;
+    } else if (arg == "--bench-buckets") {
+      options.benchBuckets = true;
+    } else if (arg == "--bench-bars") {
+      options.benchBars = true;
+    } else if (arg == "--bench-broadcast") {
+      options.benchBroadcast = true;
+    } else if (arg == "--bench-triple-buffer") {
+      options.benchTripleBuffer = true;
+    } else if (arg == "--bench-snapshot") {
+      options.benchSnapshot = true;
+    } else if (arg == "--bench-drain") {
+      options.benchDrain = true;
+    } else if (arg == "--record") {
+      if (!nextValue(options.recordPath)) {
+        return false;
+      }
+    } else if (arg == "--batch") {
+      options.batch = true;
+    } else if (arg == "--batch-out") {
+      if (!nextValue(options.batchOutputDir)) {
+        return false;
+      }
+    } else if (arg == "--jobs") {
+      std::string value;
+      if (!nextValue(value)) {
+        return false;
+      }
+      try {
+        options.jobs = static_cast<uint32_t>(std::stoul(value));
+      } catch (const std::exception &) {
+        std::cerr << "Invalid --jobs " << value << '\n';
+        return false;
+      }
+    } else if (arg == "--playlist") {
+      std::string listPath;
+      if (!nextValue(listPath) || !ReadPlaylist(listPath, options.playlist)) {
+        return false;
+      }
+    } else if (arg == "--help" || arg == "-h") {
+      PrintUsage(argv[0]);
+      return false;
+    } else if (!arg.empty() && arg[0] == '-') {
+      std::cerr << "Unknown option: " << arg << '\n';
+      PrintUsage(argv[0]);
+      return false;
+    } else {
+      options.playlist.push_back(arg);
+    }
+  }
+
+  if (!options.playlist.empty()) {
+    options.filePath = options.playlist.front();
+  }
+
+  if (options.capture && options.loopback) {
+    std::cerr << "--capture and --loopback are mutually exclusive\n";
+    return false;
+  }
+  if (options.offline && (options.capture || options.loopback)) {
+    std::cerr << "--offline needs a file, not a live input\n";
+    return false;
+  }
+  if (options.lowLatency && options.conservative) {
+    std::cerr << "--low-latency and --conservative are mutually exclusive\n";
+    return false;
+  }
+  if ((options.precompute || options.useCache || options.batch) &&
+      (options.capture || options.loopback)) {
+    std::cerr << "caches and batch analysis need files, not a live input\n";
+    return false;
+  }
+  if (!options.recordPath.empty() &&
+      (options.offline || options.precompute || options.batch)) {
+    std::cerr << "--record needs the window open\n";
+    return false;
+  }
+  if (options.useCache && (options.offline || options.precompute ||
+                           options.playlist.size() > 1)) {
+    std::cerr << "--cache plays a single file with the window open\n";
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,103 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ThreadTuning.h"
+
+struct AppOptions {
+  // select to play any file in demos directory
+  std::string filePath = "demos/audio3.wav";
+
+  // Every file given on the command line (or via --playlist), played
+  // back to back without gaps
+  std::vector<std::string> playlist;
+
+  // Headless analysis without a window or playback device
+  bool offline = false;
+  bool offlineRealtime = false;
+
+  // Read WAV input through mmap and the direct WAV path; off, WAVs are
+  // decoded like any other format, through the prefetch reader
+  bool memoryMapping = true;
+
+  // Analyze a live input instead of a file
+  bool capture = false;
+  bool loopback = false;
+  bool nullBackend = false;
+
+  // Rate the analyzer resamples to so bucket frequencies do not depend on
+  // the source (0 analyzes at the input rate)
+  uint32_t analysisRate = 48000;
+
+  // Extra visual delay for output latency the device does not report
+  int32_t avOffsetMs = 0;
+
+  // Device buffering (0 keeps the backend default). lowLatency is a preset
+  // for small periods; conservative trades latency for fewer wakeups.
+  uint32_t periodSizeInFrames = 0;
+  uint32_t periodCount = 0;
+  bool lowLatency = false;
+  bool conservative = false;
+
+  // Percentage of a device period the audio callback may use before it is
+  // counted as over budget
+  uint32_t callbackBudgetPercent = 50;
+
+  // Write a spectral cache next to each input and exit, or play using the
+  // cache instead of the live analyzer
+  bool precompute = false;
+  bool useCache = false;
+  uint32_t cacheBits = 8;
+
+  // Extract features from every input (directories are expanded) on a
+  // work-stealing pool; 0 jobs uses one worker per core
+  bool batch = false;
+  std::string batchOutputDir;
+  uint32_t jobs = 0;
+
+  // Time the analysis stages on a signal decaying into subnormals, with and
+  // without flush-to-zero, and exit
+  bool benchDenormals = false;
+
+  // Time WAV sample conversion with and without SIMD and exit
+  bool benchConversion = false;
+
+  // Decode the inputs cold and warm and report prefetch stalls, then exit
+  bool benchIo = false;
+
+  // Time the spectrum to bar reduction against the per-frame powf version
+  bool benchBuckets = false;
+
+  // Time building the bar draw calls, instance arrays vs Drawable objects
+  bool benchBars = false;
+
+  // Stress the broadcast ring with fast and lapped readers, checking every
+  // sample they read
+  bool benchBroadcast = false;
+
+  // Hammer the triple buffer from both sides and check every frame
+  bool benchTripleBuffer = false;
+
+  // Time SnapshotChannel publishes and reads against the reader count
+  bool benchSnapshot = false;
+
+  // Drain resampled offline tails and check no hop is lost or waited on
+  bool benchDrain = false;
+
+  // Also write what is played or captured to this WAV file
+  std::string recordPath;
+
+  // Affinity and scheduling per pipeline thread (--affinity, --fifo, --nice)
+  ThreadTuning::Settings analyzerTuning;
+  ThreadTuning::Settings readAheadTuning;
+  ThreadTuning::Settings renderTuning;
+  ThreadTuning::Settings workerTuning;
+};
+
+// Returns false (after printing usage) when the command line is invalid.
+bool ParseOptions(int argc, char **argv, AppOptions &options);
+
+#endif
@@ -0,0 +1,151 @@
+#include "Playlist.h"
+
+#include <algorithm>
+#include <iostream>
+
+Playlist::~Playlist() { this->Close(); }
+
+bool Playlist::Open(const std::vector<std::string> &trackFiles,
+                    const bool useMemoryMapping, const bool loopPlaylist) {
+  this->Close();
+  this->files = trackFiles;
+  this->memoryMapping = useMemoryMapping;
+  this->loop = loopPlaylist;
+
+  // the first track that opens fixes the stream's sample rate
+  for (size_t i = 0; i < this->files.size(); ++i) {
+    if (this->OpenTrack(i, this->current)) {
+      this->sampleRate_ = this->current.source->sampleRate();
+      this->currentTrack_.store(i, std::memory_order_relaxed);
+      this->StartPreload(i + 1);
+      return true;
+    }
+    std::cerr << "Skipping unreadable track " << this->files[i] << std::endl;
+  }
+  return false;
+}
+
+void Playlist::Close() {
+  if (this->loader.joinable()) {
+    this->loader.join();
+  }
+  this->current = Track{};
+  this->next = Track{};
+  this->nextLoaded = false;
+  this->sampleRate_ = 0;
+}
+
+TrackSource::Path Playlist::currentPath() const {
+  return this->current.source ? this->current.source->path()
+                              : TrackSource::Path::None;
+}
+
+// Runs on the loader thread for every track but the first.
+bool Playlist::OpenTrack(const size_t index, Track &track) const {
+  track = Track{};
+  track.index = index;
+  track.source = std::make_unique<TrackSource>();
+  if (!track.source->Open(this->files[index], this->memoryMapping,
+                          this->sampleRate_)) {
+    track.source.reset();
+    return false;
+  }
+
+  if (this->sampleRate_ != 0) {
+    track.preroll.resize(static_cast<size_t>(this->sampleRate_) *
+                         PREROLL_SECONDS);
+    const uint64_t decoded =
+        track.source->Read(track.preroll.data(), track.preroll.size());
+    track.preroll.resize(static_cast<size_t>(decoded));
+  }
+  return true;
+}
+
+void Playlist::StartPreload(size_t index) {
+  if (index >= this->files.size()) {
+    if (!this->loop) {
+      return;
+    }
+    index = 0;
+  }
+
+  this->nextLoaded = true;
+  this->loader = std::thread([this, index] {
+    if (!this->OpenTrack(index, this->next)) {
+      std::cerr << "Skipping unreadable track " << this->files[index]
+                << std::endl;
+    }
+  });
+}
+
+// Switches to the preloaded track; false when the playlist has ended.
+bool Playlist::Advance() {
+  while (this->nextLoaded) {
+    this->loader.join();
+    this->nextLoaded = false;
+
+    const size_t index = this->next.index;
+    const bool opened = this->next.source != nullptr;
+    if (opened) {
+      this->current = std::move(this->next);
+      this->next = Track{};
+      this->currentTrack_.store(index, std::memory_order_relaxed);
+    }
+    this->StartPreload(index + 1);
+
+    if (opened) {
+      return true;
+    }
+    if (index == this->current.index) {
+      // wrapped all the way round without finding a playable track
+      return false;
+    }
+  }
+  return false;
+}
+
+uint64_t Playlist::ReadTrack(Track &track, float *out, const uint64_t frames) {
+  uint64_t produced = 0;
+  if (track.prerollPos < track.preroll.size()) {
+    const auto fromPreroll = std::min<uint64_t>(
+        frames, track.preroll.size() - track.prerollPos);
+    std::copy_n(track.preroll.begin() +
+                    static_cast<std::ptrdiff_t>(track.prerollPos),
+                fromPreroll, out);
+    track.prerollPos += static_cast<size_t>(fromPreroll);
+    produced = fromPreroll;
+  }
+  if (produced < frames) {
+    produced += track.source->Read(out + produced, frames - produced);
+  }
+  track.position += produced;
+  return produced;
+}
+
+uint64_t Playlist::Read(float *out, const uint64_t frames) {
+  uint64_t produced = 0;
+  while (produced < frames && this->current.source) {
+    const uint64_t got =
+        this->ReadTrack(this->current, out + produced, frames - produced);
+    produced += got;
+
+    if (got == 0 && !this->Advance()) {
+      break;
+    }
+  }
+  return produced;
+}
+
+bool Playlist::SeekToFrame(const uint64_t frame) {
+  if (!this->current.source) {
+    return false;
+  }
+  // the preroll only exists to cover the start of a track
+  this->current.preroll.clear();
+  this->current.prerollPos = 0;
+  if (!this->current.source->SeekToFrame(frame)) {
+    return false;
+  }
+  this->current.position = frame;
+  return true;
+}
@@ -0,0 +1,87 @@
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TrackSource.h"
+
+/*
+        Gapless Playlist
+
+        Presents a list of files as one continuous mono PCM stream at the
+   first track's sample rate.
+
+        * While a track plays, a loader thread opens the next one (resampled
+   to the stream rate if needed) and pre-decodes its first seconds.
+        * When the current track runs out mid-read, the rest of the same read
+   is filled from the next track, so the splice is sample accurate and the
+   analyzer window runs straight across the boundary.
+        * With looping enabled the list wraps around; a single-file playlist
+   therefore loops that file gaplessly.
+
+        Read() and SeekToFrame() must be called from one thread (the decoder
+   read-ahead thread or the offline loop).
+*/
+
+class Playlist {
+public:
+  Playlist() = default;
+  Playlist(const Playlist &) = delete;
+  Playlist(Playlist &&) = delete;
+  Playlist &operator=(const Playlist &) = delete;
+  Playlist &operator=(Playlist &&) = delete;
+  ~Playlist();
+
+  bool Open(const std::vector<std::string> &files, bool memoryMapping,
+            bool loop);
+  void Close();
+
+  uint64_t Read(float *out, uint64_t frames);
+  // seeks within the current track
+  bool SeekToFrame(uint64_t frame);
+  // frame of the current track the next Read() starts at
+  [[nodiscard]] uint64_t trackPosition() const {
+    return this->current.position;
+  }
+
+  [[nodiscard]] uint32_t sampleRate() const { return sampleRate_; }
+  [[nodiscard]] size_t currentTrack() const {
+    return currentTrack_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] TrackSource::Path currentPath() const;
+
+private:
+  constexpr static unsigned PREROLL_SECONDS = 2;
+
+  struct Track {
+    std::unique_ptr<TrackSource> source;
+    std::vector<float> preroll;
+    size_t prerollPos{0};
+    size_t index{0};
+    uint64_t position{0};
+  };
+
+  bool OpenTrack(size_t index, Track &track) const;
+  void StartPreload(size_t index);
+  bool Advance();
+  uint64_t ReadTrack(Track &track, float *out, uint64_t frames);
+
+  std::vector<std::string> files;
+  bool memoryMapping{true};
+  bool loop{true};
+  uint32_t sampleRate_{0};
+
+  Track current;
+  Track next;
+  bool nextLoaded{false};
+  std::thread loader;
+  std::atomic<size_t> currentTrack_{0};
+};
+
+#endif
@@ -0,0 +1,412 @@
+#include "PrefetchReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Clock.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+PrefetchReader::~PrefetchReader() { this->Close(); }
+
+const char *PrefetchReader::BackendName(const Backend backend) {
+  switch (backend) {
+  case Backend::IoUring:
+    return "io_uring";
+  case Backend::ReaderThread:
+    return "reader thread";
+  default:
+    return "none";
+  }
+}
+
+bool PrefetchReader::DropCache(const std::string &path) {
+#if defined(__linux__)
+  const int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (file < 0) {
+    return false;
+  }
+  const bool ok = posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  close(file);
+  return ok;
+#else
+  (void)path;
+  return false;
+#endif
+}
+
+bool PrefetchReader::Open(const std::string &path) {
+  this->Close();
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return false;
+  }
+  this->fileHandle = file;
+  this->fileSize = static_cast<uint64_t>(size.QuadPart);
+#else
+  this->fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (this->fd < 0) {
+    return false;
+  }
+  struct stat info {};
+  if (fstat(this->fd, &info) != 0) {
+    close(this->fd);
+    this->fd = -1;
+    return false;
+  }
+  this->fileSize = static_cast<uint64_t>(info.st_size);
+#endif
+
+  for (Slot &slot : this->slots) {
+    if (!slot.data) {
+      slot.data = std::make_unique<uint8_t[]>(CHUNK_SIZE);
+    }
+    slot.chunk = -1;
+    slot.length = 0;
+    slot.state.store(SlotState::Empty, std::memory_order_relaxed);
+  }
+  this->position = 0;
+  for (auto *counter : {&this->reads, &this->seeks, &this->chunksFetched,
+                        &this->stalls}) {
+    counter->store(0, std::memory_order_relaxed);
+  }
+  this->stallNs.store(0, std::memory_order_relaxed);
+  this->maxStallNs.store(0, std::memory_order_relaxed);
+
+#if defined(HAVE_LIBURING)
+  // may be refused by older kernels or seccomp policies
+  if (io_uring_queue_init(SLOT_COUNT, &this->ring, 0) == 0) {
+    this->inFlight = 0;
+    this->backend_ = Backend::IoUring;
+  }
+#endif
+  if (this->backend_ == Backend::None) {
+    this->stopping = false;
+    this->reader = std::thread(&PrefetchReader::ReaderLoop, this);
+    this->backend_ = Backend::ReaderThread;
+  }
+
+  this->Prefetch(0);
+  return true;
+}
+
+void PrefetchReader::Close() {
+  if (this->backend_ == Backend::None) {
+    return;
+  }
+  this->Drain();
+#if defined(HAVE_LIBURING)
+  if (this->backend_ == Backend::IoUring) {
+    io_uring_queue_exit(&this->ring);
+  }
+#endif
+  this->backend_ = Backend::None;
+
+#if defined(_WIN32)
+  CloseHandle(static_cast<HANDLE>(this->fileHandle));
+  this->fileHandle = nullptr;
+#else
+  close(this->fd);
+  this->fd = -1;
+#endif
+}
+
+// Waits until no read still targets a slot buffer.
+void PrefetchReader::Drain() {
+#if defined(HAVE_LIBURING)
+  if (this->backend_ == Backend::IoUring) {
+    while (this->inFlight > 0) {
+      this->ReapCompletions(true);
+    }
+    return;
+  }
+#endif
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (Slot *slot : this->requests) {
+      slot->state.store(SlotState::Empty, std::memory_order_relaxed);
+    }
+    this->requests.clear();
+    this->stopping = true;
+  }
+  this->requestReady.notify_one();
+  if (this->reader.joinable()) {
+    this->reader.join();
+  }
+}
+
+size_t PrefetchReader::Read(void *out, const size_t bytes) {
+  bump(this->reads, 1);
+  auto *dst = static_cast<uint8_t *>(out);
+  size_t done = 0;
+  while (done < bytes && static_cast<uint64_t>(this->position) < this->fileSize) {
+    const int64_t chunk = this->position / static_cast<int64_t>(CHUNK_SIZE);
+    this->Prefetch(chunk);
+
+    Slot &slot = this->slots[static_cast<size_t>(chunk) % SLOT_COUNT];
+    if (slot.chunk != chunk ||
+        slot.state.load(std::memory_order_acquire) != SlotState::Ready) {
+      const int64_t startNs = NowNanos();
+      const bool ok = this->WaitFor(slot, chunk);
+      const int64_t waitedNs = NowNanos() - startNs;
+      bump(this->stalls, 1);
+      this->stallNs.store(this->stallNs.load(std::memory_order_relaxed) +
+                              waitedNs,
+                          std::memory_order_relaxed);
+      if (waitedNs > this->maxStallNs.load(std::memory_order_relaxed)) {
+        this->maxStallNs.store(waitedNs, std::memory_order_relaxed);
+      }
+      if (!ok) {
+        break;
+      }
+    }
+
+    const auto offset = static_cast<size_t>(
+        this->position - chunk * static_cast<int64_t>(CHUNK_SIZE));
+    if (offset >= slot.length) {
+      break;
+    }
+    const size_t n = std::min(bytes - done, slot.length - offset);
+    std::memcpy(dst + done, slot.data.get() + offset, n);
+    done += n;
+    this->position += static_cast<int64_t>(n);
+  }
+  return done;
+}
+
+bool PrefetchReader::Seek(const int64_t offset, const int origin) {
+  const int64_t base = origin == 1   ? this->position
+                       : origin == 2 ? static_cast<int64_t>(this->fileSize)
+                                     : 0;
+  const int64_t target = base + offset;
+  if (target < 0 || static_cast<uint64_t>(target) > this->fileSize) {
+    return false;
+  }
+  bump(this->seeks, 1);
+  this->position = target;
+  // start filling the new window before the decoder asks for it
+  this->Prefetch(target / static_cast<int64_t>(CHUNK_SIZE));
+  return true;
+}
+
+PrefetchReader::Stats PrefetchReader::GetStats() const {
+  Stats stats;
+  stats.reads = this->reads.load(std::memory_order_relaxed);
+  stats.seeks = this->seeks.load(std::memory_order_relaxed);
+  stats.chunksFetched = this->chunksFetched.load(std::memory_order_relaxed);
+  stats.stalls = this->stalls.load(std::memory_order_relaxed);
+  stats.stallNs = this->stallNs.load(std::memory_order_relaxed);
+  stats.maxStallNs = this->maxStallNs.load(std::memory_order_relaxed);
+  return stats;
+}
+
+// Requests every chunk of the window that is not already loaded or loading.
+// Slots still busy with a chunk that fell out of the window are skipped and
+// picked up by a later call.
+void PrefetchReader::Prefetch(const int64_t firstChunk) {
+#if defined(HAVE_LIBURING)
+  if (this->backend_ == Backend::IoUring) {
+    this->ReapCompletions(false);
+  }
+#endif
+  for (int64_t chunk = firstChunk;
+       chunk < firstChunk + static_cast<int64_t>(SLOT_COUNT); ++chunk) {
+    if (static_cast<uint64_t>(chunk) * CHUNK_SIZE >= this->fileSize) {
+      break;
+    }
+    Slot &slot = this->slots[static_cast<size_t>(chunk) % SLOT_COUNT];
+    if (slot.chunk == chunk ||
+        slot.state.load(std::memory_order_acquire) == SlotState::InFlight) {
+      continue;
+    }
+    this->Submit(slot, chunk);
+  }
+}
+
+void PrefetchReader::Submit(Slot &slot, const int64_t chunk) {
+  slot.chunk = chunk;
+  slot.length = 0;
+  slot.state.store(SlotState::InFlight, std::memory_order_relaxed);
+  bump(this->chunksFetched, 1);
+
+#if defined(HAVE_LIBURING)
+  if (this->backend_ == Backend::IoUring) {
+    // at most SLOT_COUNT reads are in flight, the ring's depth
+    io_uring_sqe *sqe = io_uring_get_sqe(&this->ring);
+    io_uring_prep_read(sqe, this->fd, slot.data.get(),
+                       static_cast<unsigned>(this->ChunkLength(chunk)),
+                       static_cast<uint64_t>(chunk) * CHUNK_SIZE);
+    io_uring_sqe_set_data(sqe, &slot);
+    io_uring_submit(&this->ring);
+    ++this->inFlight;
+    return;
+  }
+#endif
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->requests.push_back(&slot);
+  }
+  this->requestReady.notify_one();
+}
+
+// Blocks until slot holds chunk, requesting it if the slot is free.
+bool PrefetchReader::WaitFor(Slot &slot, const int64_t chunk) {
+  while (true) {
+    const SlotState state = slot.state.load(std::memory_order_acquire);
+    if (slot.chunk == chunk && state == SlotState::Ready) {
+      return true;
+    }
+    if (slot.chunk == chunk && state == SlotState::Failed) {
+      return false;
+    }
+    if (state != SlotState::InFlight) {
+      this->Submit(slot, chunk);
+      continue;
+    }
+
+#if defined(HAVE_LIBURING)
+    if (this->backend_ == Backend::IoUring) {
+      if (!this->ReapCompletions(true)) {
+        return false;
+      }
+      continue;
+    }
+#endif
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->chunkReady.wait(lock, [&slot] {
+      return slot.state.load(std::memory_order_acquire) != SlotState::InFlight;
+    });
+  }
+}
+
+size_t PrefetchReader::ChunkLength(const int64_t chunk) const {
+  const uint64_t start = static_cast<uint64_t>(chunk) * CHUNK_SIZE;
+  return start >= this->fileSize
+             ? 0
+             : static_cast<size_t>(
+                   std::min<uint64_t>(CHUNK_SIZE, this->fileSize - start));
+}
+
+#if defined(HAVE_LIBURING)
+// Applies finished reads; returns false if nothing completed (or waiting
+// failed).
+bool PrefetchReader::ReapCompletions(const bool block) {
+  io_uring_cqe *cqe = nullptr;
+  if (block ? io_uring_wait_cqe(&this->ring, &cqe) != 0
+            : io_uring_peek_cqe(&this->ring, &cqe) != 0) {
+    return false;
+  }
+  do {
+    auto *slot = static_cast<Slot *>(io_uring_cqe_get_data(cqe));
+    const int result = cqe->res;
+    io_uring_cqe_seen(&this->ring, cqe);
+    --this->inFlight;
+
+    if (result < 0) {
+      slot->state.store(SlotState::Failed, std::memory_order_release);
+      continue;
+    }
+    slot->length += static_cast<size_t>(result);
+    const size_t expected = this->ChunkLength(slot->chunk);
+    if (result > 0 && slot->length < expected) {
+      // short read (network filesystems do this); ask for the rest
+      io_uring_sqe *sqe = io_uring_get_sqe(&this->ring);
+      io_uring_prep_read(
+          sqe, this->fd, slot->data.get() + slot->length,
+          static_cast<unsigned>(expected - slot->length),
+          static_cast<uint64_t>(slot->chunk) * CHUNK_SIZE + slot->length);
+      io_uring_sqe_set_data(sqe, slot);
+      io_uring_submit(&this->ring);
+      ++this->inFlight;
+      continue;
+    }
+    slot->state.store(slot->length > 0 ? SlotState::Ready : SlotState::Failed,
+                      std::memory_order_release);
+  } while (io_uring_peek_cqe(&this->ring, &cqe) == 0);
+  return true;
+}
+#endif
+
+void PrefetchReader::ReaderLoop() {
+  while (true) {
+    Slot *slot = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->requestReady.wait(
+          lock, [this] { return this->stopping || !this->requests.empty(); });
+      if (this->stopping) {
+        return;
+      }
+      slot = this->requests.front();
+      this->requests.pop_front();
+    }
+
+    const size_t length = this->ReadAt(
+        static_cast<uint64_t>(slot->chunk) * CHUNK_SIZE, slot->data.get(),
+        this->ChunkLength(slot->chunk));
+    {
+      // under the lock so a waiter cannot miss the change
+      std::lock_guard<std::mutex> lock(this->mutex);
+      slot->length = length;
+      slot->state.store(length > 0 ? SlotState::Ready : SlotState::Failed,
+                        std::memory_order_release);
+    }
+    this->chunkReady.notify_all();
+  }
+}
+
+// Positional read that retries short reads; returns the bytes read.
+size_t PrefetchReader::ReadAt(const uint64_t offset, uint8_t *out,
+                              const size_t bytes) const {
+  size_t done = 0;
+  while (done < bytes) {
+#if defined(_WIN32)
+    OVERLAPPED at{};
+    const uint64_t from = offset + done;
+    at.Offset = static_cast<DWORD>(from);
+    at.OffsetHigh = static_cast<DWORD>(from >> 32);
+    DWORD got = 0;
+    if (!ReadFile(static_cast<HANDLE>(this->fileHandle), out + done,
+                  static_cast<DWORD>(bytes - done), &got, &at) ||
+        got == 0) {
+      break;
+    }
+#else
+    const ssize_t got = pread(this->fd, out + done, bytes - done,
+                              static_cast<off_t>(offset + done));
+    if (got < 0 && errno == EINTR) {
+      continue;
+    }
+    if (got <= 0) {
+      break;
+    }
+#endif
+    done += static_cast<size_t>(got);
+  }
+  return done;
+}
+
+// single writer (the decoding thread), so a plain load/store is enough
+void PrefetchReader::bump(std::atomic<uint64_t> &counter,
+                          const uint64_t amount) {
+  counter.store(counter.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+}
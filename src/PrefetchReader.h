@@ -0,0 +1,133 @@
+#ifndef PREFETCH_READER_H
+#define PREFETCH_READER_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#if defined(HAVE_LIBURING)
+#include <liburing.h>
+#endif
+
+/*
+        Prefetching File Reader
+
+        Byte source for ma_decoder's onRead/onSeek callbacks that keeps a
+   window of fixed-size chunks ahead of the decoder's position in flight, so
+   decoding a compressed file from slow or network storage reads from memory
+   instead of blocking on the disk.
+
+        * io_uring (when built with liburing and the kernel allows it): reads
+   are submitted and reaped by the decoding thread itself.
+        * Otherwise a reader thread serves the same requests with positional
+   reads.
+        * Chunk i lives in slot i % SLOT_COUNT; a seek simply moves the
+   window, and slots outside it are recycled once their read completes.
+        * A stall is a wait inside Read() for a chunk that has not arrived.
+   The first read after opening or seeking usually stalls; with the window
+   ahead of the decoder the rest should not.
+
+        Read(), Seek() and Tell() belong to one thread (whichever drives the
+   decoder); GetStats() may be called from any thread.
+*/
+
+class PrefetchReader {
+public:
+  enum class Backend { None, IoUring, ReaderThread };
+
+  struct Stats {
+    uint64_t reads{0};
+    uint64_t seeks{0};
+    uint64_t chunksFetched{0};
+    uint64_t stalls{0};
+    int64_t stallNs{0};
+    int64_t maxStallNs{0};
+  };
+
+  constexpr static size_t CHUNK_SIZE = 256 * 1024;
+  constexpr static size_t SLOT_COUNT = 16;
+
+  PrefetchReader() = default;
+  PrefetchReader(const PrefetchReader &) = delete;
+  PrefetchReader(PrefetchReader &&) = delete;
+  PrefetchReader &operator=(const PrefetchReader &) = delete;
+  PrefetchReader &operator=(PrefetchReader &&) = delete;
+  ~PrefetchReader();
+
+  bool Open(const std::string &path);
+  void Close();
+
+  // Asks the kernel to evict the file's cached pages, to measure cold reads
+  // (Linux only). Returns whether the hint was given.
+  static bool DropCache(const std::string &path);
+
+  size_t Read(void *out, size_t bytes);
+  // origin: 0 start, 1 current, 2 end (ma_seek_origin)
+  bool Seek(int64_t offset, int origin);
+  [[nodiscard]] int64_t Tell() const { return this->position; }
+  [[nodiscard]] uint64_t size() const { return this->fileSize; }
+  [[nodiscard]] Backend backend() const { return this->backend_; }
+  [[nodiscard]] static const char *BackendName(Backend backend);
+
+  [[nodiscard]] Stats GetStats() const;
+
+private:
+  enum class SlotState : uint8_t { Empty, InFlight, Ready, Failed };
+
+  struct Slot {
+    std::unique_ptr<uint8_t[]> data;
+    int64_t chunk{-1};
+    size_t length{0};
+    std::atomic<SlotState> state{SlotState::Empty};
+  };
+
+  void Prefetch(int64_t firstChunk);
+  void Submit(Slot &slot, int64_t chunk);
+  bool WaitFor(Slot &slot, int64_t chunk);
+  size_t ChunkLength(int64_t chunk) const;
+  size_t ReadAt(uint64_t offset, uint8_t *out, size_t bytes) const;
+  void ReaderLoop();
+  void Drain();
+  static void bump(std::atomic<uint64_t> &counter, uint64_t amount);
+
+  Backend backend_{Backend::None};
+  uint64_t fileSize{0};
+  int64_t position{0};
+  std::array<Slot, SLOT_COUNT> slots;
+
+#if defined(_WIN32)
+  void *fileHandle{nullptr};
+#else
+  int fd{-1};
+#endif
+
+#if defined(HAVE_LIBURING)
+  bool ReapCompletions(bool block);
+  io_uring ring{};
+  size_t inFlight{0};
+#endif
+
+  // reader thread backend
+  std::thread reader;
+  std::mutex mutex;
+  std::condition_variable requestReady;
+  std::condition_variable chunkReady;
+  std::deque<Slot *> requests;
+  bool stopping{false};
+
+  std::atomic<uint64_t> reads{0};
+  std::atomic<uint64_t> seeks{0};
+  std::atomic<uint64_t> chunksFetched{0};
+  std::atomic<uint64_t> stalls{0};
+  std::atomic<int64_t> stallNs{0};
+  std::atomic<int64_t> maxStallNs{0};
+};
+
+#endif
@@ -0,0 +1,130 @@
+#include "ReadAheadThread.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "Denormals.h"
+
+ReadAheadThread::ReadAheadThread(Playlist &source, RingBuffer &pcmQueue,
+                                 const size_t readAheadFrames)
+    : source(source), pcmQueue(pcmQueue),
+      readAheadFrames(std::min(readAheadFrames,
+                               RingBuffer::BUFFER_SIZE - 2 * CHUNK_FRAMES)) {}
+
+ReadAheadThread::~ReadAheadThread() { this->Stop(); }
+
+void ReadAheadThread::Launch() {
+  this->running.store(true);
+  this->mThread = std::thread(std::ref(*this));
+}
+
+void ReadAheadThread::SetTuning(const ThreadTuning::Settings &settings) {
+  this->tuning = settings;
+}
+
+void ReadAheadThread::Stop() {
+  this->running.store(false);
+  if (mThread.joinable()) {
+    mThread.join();
+  }
+}
+
+void ReadAheadThread::operator()() {
+  // sleep for a fraction of the read-ahead whenever the ring is topped up,
+  // the callback drains at most one period in that time
+  constexpr auto idleSleep = std::chrono::milliseconds(5);
+
+  ThreadTuning::Apply("read-ahead", this->tuning);
+  // the decoder's resampling filters decay into subnormals at track ends
+  DisableDenormals();
+
+  while (this->running.load(std::memory_order_relaxed)) {
+    if (!this->Fill()) {
+      std::this_thread::sleep_for(idleSleep);
+    }
+  }
+}
+
+bool ReadAheadThread::WaitUntilPrimed(const std::chrono::milliseconds timeout) {
+  return this->pcmQueue.WaitForAvailable(this->readAheadFrames, timeout);
+}
+
+uint64_t ReadAheadThread::GetFramesDecoded() const {
+  return this->framesDecoded.load(std::memory_order_relaxed);
+}
+
+bool ReadAheadThread::PostCommand(const TransportCommand &command) {
+  return this->commands.Push(command);
+}
+
+void ReadAheadThread::ApplyCommands() {
+  TransportCommand command;
+  while (this->commands.Pop(command)) {
+    switch (command.type) {
+    case TransportCommand::Type::Seek:
+      this->JumpTo(command.start, true);
+      break;
+    case TransportCommand::Type::SetLoop:
+      this->looping = command.end > command.start;
+      this->loopStart = command.start;
+      this->loopEnd = command.end;
+      break;
+    case TransportCommand::Type::ClearLoop:
+      this->looping = false;
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+// Repositions the decoder and tells the callback where the jump lands in the
+// ring. A flush also drops everything still queued from before the jump.
+void ReadAheadThread::JumpTo(const uint64_t frame, const bool flush) {
+  if (!this->source.SeekToFrame(frame)) {
+    std::cerr << "Seek to frame " << frame << " failed" << '\n';
+  }
+  this->sourcePosition = this->source.trackPosition();
+  // the segment goes first: once the callback sees the flush it applies the
+  // segments up to its new position, and this one must already be there
+  this->segments.Push({this->framesPushed, this->sourcePosition});
+  if (flush) {
+    this->pcmQueue.RequestFlush();
+  }
+}
+
+// Decodes one chunk if the ring is below the read-ahead target.
+bool ReadAheadThread::Fill() {
+  this->ApplyCommands();
+  if (this->looping && this->sourcePosition >= this->loopEnd) {
+    this->JumpTo(this->loopStart, false);
+  }
+
+  const size_t buffered = this->pcmQueue.GetAvailable();
+  if (buffered >= this->readAheadFrames) {
+    return false;
+  }
+
+  size_t wanted = std::min(CHUNK_FRAMES, this->readAheadFrames - buffered);
+  if (this->looping) {
+    wanted = static_cast<size_t>(
+        std::min<uint64_t>(wanted, this->loopEnd - this->sourcePosition));
+  }
+  const uint64_t framesRead = this->source.Read(this->chunk, wanted);
+
+  // the playlist moved on to the next track part way through this read; a
+  // loop region belongs to the track it was set on
+  const uint64_t position = this->source.trackPosition();
+  if (position != this->sourcePosition + framesRead) {
+    this->segments.Push({this->framesPushed + framesRead - position, 0});
+    this->looping = false;
+  }
+  this->sourcePosition = position;
+
+  this->framesPushed +=
+      this->pcmQueue.PushBulk(this->chunk, static_cast<size_t>(framesRead));
+  this->framesDecoded.store(this->framesDecoded.load(std::memory_order_relaxed) +
+                                framesRead,
+                            std::memory_order_relaxed);
+  return framesRead > 0;
+}
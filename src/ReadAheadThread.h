@@ -0,0 +1,85 @@
+#ifndef READ_AHEAD_THREAD_H
+#define READ_AHEAD_THREAD_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "CommandQueue.h"
+#include "Playlist.h"
+#include "RingBuffer.h"
+#include "ThreadTuning.h"
+#include "Transport.h"
+
+/*
+        Decoder Read-Ahead Thread
+
+        Keeps file I/O and codec work off the real-time audio thread. The
+   decoder is only ever touched here; it decodes into an SPSC RingBuffer
+   that is kept a fixed amount ahead of playback, so the device callback
+   is left with a memcpy out of that ring.
+
+        Looping and track changes are handled by the Playlist, so the ring
+   sees one continuous stream.
+
+        Seeks and loop regions arrive from the audio callback through a
+   command queue. A seek flushes the ring, so stale audio is never played,
+   and every jump in the stream (seek, loop wrap, next track) is reported
+   back as a StreamSegment.
+*/
+
+class ReadAheadThread {
+public:
+  ReadAheadThread(Playlist &source, RingBuffer &pcmQueue,
+                  size_t readAheadFrames);
+  ReadAheadThread(const ReadAheadThread &) = delete;
+  ReadAheadThread(ReadAheadThread &&) = delete;
+  ReadAheadThread &operator=(const ReadAheadThread &) = delete;
+  ReadAheadThread &operator=(ReadAheadThread &&) = delete;
+  ~ReadAheadThread();
+
+  void operator()();
+  void Launch();
+  void Stop();
+  // applied when the thread starts; call before Launch()
+  void SetTuning(const ThreadTuning::Settings &settings);
+
+  // Blocks until the ring holds the full read-ahead (or timeout)
+  bool WaitUntilPrimed(std::chrono::milliseconds timeout);
+
+  uint64_t GetFramesDecoded() const;
+
+  /* Audio callback side */
+  bool PostCommand(const TransportCommand &command);
+  CommandQueue<StreamSegment, 64> &Segments() { return this->segments; }
+
+private:
+  constexpr static size_t CHUNK_FRAMES = 1024;
+
+  void ApplyCommands();
+  void JumpTo(uint64_t frame, bool flush);
+  bool Fill();
+
+  Playlist &source;
+  RingBuffer &pcmQueue;
+  size_t readAheadFrames;
+
+  ThreadTuning::Settings tuning;
+  std::atomic<bool> running{false};
+  std::atomic<uint64_t> framesDecoded{0};
+
+  CommandQueue<TransportCommand, 64> commands;
+  CommandQueue<StreamSegment, 64> segments;
+  // frames pushed into the ring and the track frame the next one comes from
+  uint64_t framesPushed{0};
+  uint64_t sourcePosition{0};
+  bool looping{false};
+  uint64_t loopStart{0};
+  uint64_t loopEnd{0};
+  float chunk[CHUNK_FRAMES]{};
+  std::thread mThread;
+};
+
+#endif
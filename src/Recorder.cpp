@@ -0,0 +1,110 @@
+#include "Recorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "ThreadTuning.h"
+
+Recorder::Recorder(BroadcastRing &input) : input(input) {}
+
+Recorder::~Recorder() { Stop(); }
+
+bool Recorder::Open(const std::string &path, const uint32_t sampleRate) {
+  const ma_encoder_config config = ma_encoder_config_init(
+      ma_encoding_format_wav, ma_format_f32, 1, sampleRate);
+  if (ma_encoder_init_file(path.c_str(), &config, &this->encoder) !=
+      MA_SUCCESS) {
+    std::cerr << "Could not create recording " << path << '\n';
+    return false;
+  }
+  this->encoderReady = true;
+  this->scratch.resize(CHUNK_FRAMES);
+  return true;
+}
+
+void Recorder::Launch() {
+  if (!this->encoderReady) {
+    return;
+  }
+  // subscribe here rather than at Open() so nothing pushed before playback
+  // starts counts against the recorder
+  this->inputId =
+      this->input.Subscribe(BroadcastRing::LagPolicy::MarkLagging);
+  if (this->inputId < 0) {
+    std::cerr << "Recorder: no free broadcast reader\n";
+    return;
+  }
+  this->mThread = std::thread(&Recorder::operator(), this);
+}
+
+void Recorder::Stop() {
+  this->stopFlag.store(true, std::memory_order_relaxed);
+  if (this->mThread.joinable()) {
+    this->mThread.join();
+  }
+  if (this->inputId >= 0) {
+    this->input.Unsubscribe(this->inputId);
+    this->inputId = -1;
+  }
+  if (this->encoderReady) {
+    ma_encoder_uninit(&this->encoder);
+    this->encoderReady = false;
+  }
+}
+
+void Recorder::operator()() {
+  // names the thread; disk writes need no special scheduling
+  ThreadTuning::Apply("recorder", ThreadTuning::Settings{});
+  constexpr auto waitTimeout = std::chrono::milliseconds(50);
+  while (true) {
+    const bool stopping = this->stopFlag.load(std::memory_order_relaxed);
+
+    if (this->input.IsLagging(this->inputId)) {
+      bump(this->laps, 1);
+      const uint64_t skipped = this->input.Resync(this->inputId);
+      WriteSilence(skipped);
+      bump(this->framesLost, skipped);
+    }
+
+    const size_t got = this->input.Pop(this->inputId, this->scratch.data(),
+                                       this->scratch.size());
+    if (got > 0) {
+      Write(this->scratch.data(), got);
+      continue;
+    }
+    if (stopping) {
+      return;
+    }
+    this->input.WaitForAvailable(this->inputId, CHUNK_FRAMES / 4,
+                                 waitTimeout);
+  }
+}
+
+void Recorder::Write(const float *samples, const uint64_t count) {
+  ma_uint64 written = 0;
+  ma_encoder_write_pcm_frames(&this->encoder, samples, count, &written);
+  bump(this->framesWritten, written);
+}
+
+void Recorder::WriteSilence(uint64_t count) {
+  std::fill(this->scratch.begin(), this->scratch.end(), 0.0f);
+  while (count > 0) {
+    const uint64_t chunk = std::min<uint64_t>(count, this->scratch.size());
+    Write(this->scratch.data(), chunk);
+    count -= chunk;
+  }
+}
+
+void Recorder::bump(std::atomic<uint64_t> &counter, const uint64_t amount) {
+  counter.store(counter.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+}
+
+Recorder::Stats Recorder::GetStats() const {
+  Stats stats;
+  stats.framesWritten = this->framesWritten.load(std::memory_order_relaxed);
+  stats.framesLost = this->framesLost.load(std::memory_order_relaxed);
+  stats.laps = this->laps.load(std::memory_order_relaxed);
+  return stats;
+}
@@ -0,0 +1,70 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BroadcastRing.h"
+#include "miniaudio.h"
+
+/*
+        Recorder
+
+        Writes what the engine plays (or captures) to a mono 32-bit float WAV
+   file, as a second reader of the engine's broadcast ring next to the
+   analyzer.
+
+        * Runs on its own thread; file I/O never touches the audio callback.
+        * Keeps every sample, seeks included, so the file is the exact output.
+        * If disk writes stall long enough for the ring to lap it, the lost
+   stretch is written as silence so the rest of the file stays in time.
+*/
+
+class Recorder {
+public:
+  struct Stats {
+    uint64_t framesWritten{0};
+    // silence written in place of samples lost to a lap
+    uint64_t framesLost{0};
+    uint64_t laps{0};
+  };
+
+  explicit Recorder(BroadcastRing &input);
+  Recorder(const Recorder &) = delete;
+  Recorder(Recorder &&) = delete;
+  Recorder &operator=(const Recorder &) = delete;
+  Recorder &operator=(Recorder &&) = delete;
+  ~Recorder();
+
+  bool Open(const std::string &path, uint32_t sampleRate);
+  void Launch();
+  // drains what is already in the ring, then closes the file
+  void Stop();
+
+  Stats GetStats() const;
+
+private:
+  void operator()();
+  void Write(const float *samples, uint64_t count);
+  void WriteSilence(uint64_t count);
+  static void bump(std::atomic<uint64_t> &counter, uint64_t amount);
+
+  constexpr static size_t CHUNK_FRAMES = 4096;
+
+  BroadcastRing &input;
+  int inputId{-1};
+  ma_encoder encoder{};
+  bool encoderReady{false};
+  std::vector<float> scratch;
+  std::thread mThread;
+  std::atomic<bool> stopFlag{false};
+
+  std::atomic<uint64_t> framesWritten{0};
+  std::atomic<uint64_t> framesLost{0};
+  std::atomic<uint64_t> laps{0};
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include "Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define RESAMPLER_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RESAMPLER_NEON 1
+#endif
+
+void Resampler::Configure(const uint32_t inputRate, const uint32_t outputRate) {
+  const uint32_t divisor = std::gcd(inputRate, outputRate);
+  this->up = outputRate / divisor;
+  this->down = inputRate / divisor;
+  this->Reset();
+
+  if (this->IsBypass()) {
+    this->coefficients.clear();
+    return;
+  }
+
+  // prototype runs at the upsampled rate L * inputRate; cut off just below
+  // the lower Nyquist (in cycles per upsampled sample) so the transition
+  // band does not alias back into the output
+  const size_t length = static_cast<size_t>(this->up) * TAPS;
+  const double cutoff =
+      0.45 / static_cast<double>(std::max(this->up, this->down));
+  const double center = static_cast<double>(length - 1) / 2.0;
+  constexpr double pi = 3.14159265358979323846;
+
+  std::vector<double> prototype(length);
+  for (size_t n = 0; n < length; ++n) {
+    const double x = static_cast<double>(n) - center;
+    const double sinc = x == 0.0 ? 2.0 * cutoff
+                                 : std::sin(2.0 * pi * cutoff * x) / (pi * x);
+    // Blackman window
+    const double w = 0.42 -
+                     0.5 * std::cos(2.0 * pi * n / (length - 1)) +
+                     0.08 * std::cos(4.0 * pi * n / (length - 1));
+    // gain L restores the level lost to zero-stuffing
+    prototype[n] = sinc * w * this->up;
+  }
+
+  // phase p holds prototype[p + k * L]; store it reversed so the dot
+  // product walks the input window oldest to newest
+  this->coefficients.assign(length, 0.0f);
+  for (uint32_t p = 0; p < this->up; ++p) {
+    float *dst = &this->coefficients[p * TAPS];
+    for (size_t k = 0; k < TAPS; ++k) {
+      dst[TAPS - 1 - k] = static_cast<float>(prototype[p + k * this->up]);
+    }
+  }
+}
+
+void Resampler::Reset() {
+  // TAPS - 1 samples of silence so the first output has a full window
+  this->history.assign(TAPS - 1, 0.0f);
+  this->index = TAPS - 1;
+  this->phase = 0;
+}
+
+void Resampler::Process(const float *in, const size_t inCount,
+                        std::vector<float> &out) {
+  if (this->IsBypass()) {
+    out.insert(out.end(), in, in + inCount);
+    return;
+  }
+
+  this->history.insert(this->history.end(), in, in + inCount);
+
+  // index is the newest input sample the next output depends on
+  while (this->index < this->history.size()) {
+    const float *window = &this->history[this->index + 1 - TAPS];
+    out.push_back(Dot(&this->coefficients[this->phase * TAPS], window));
+
+    this->phase += this->down;
+    this->index += this->phase / this->up;
+    this->phase %= this->up;
+  }
+
+  // keep only the window the next output still needs
+  const size_t consumed = this->index + 1 - TAPS;
+  this->history.erase(this->history.begin(),
+                      this->history.begin() +
+                          static_cast<std::ptrdiff_t>(
+                              std::min(consumed, this->history.size())));
+  this->index -= consumed;
+}
+
+size_t Resampler::InputNeeded(const size_t outCount) const {
+  if (this->IsBypass()) {
+    return outCount;
+  }
+  // position of the last requested output in input samples, relative to
+  // what is already buffered
+  const uint64_t last =
+      this->index +
+      (this->phase + (outCount - 1) * uint64_t{this->down}) / this->up;
+  return last < this->history.size()
+             ? 0
+             : static_cast<size_t>(last + 1 - this->history.size());
+}
+
+float Resampler::Dot(const float *a, const float *b) {
+  static_assert(TAPS % 8 == 0, "dot product is unrolled by 8");
+#if defined(RESAMPLER_SSE)
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+  for (size_t i = 0; i < TAPS; i += 8) {
+    acc0 = _mm_add_ps(acc0,
+                      _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4),
+                                       _mm_loadu_ps(b + i + 4)));
+  }
+  const __m128 sum = _mm_add_ps(acc0, acc1);
+  alignas(16) float lanes[4];
+  _mm_store_ps(lanes, sum);
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(RESAMPLER_NEON)
+  float32x4_t acc0 = vdupq_n_f32(0.0f);
+  float32x4_t acc1 = vdupq_n_f32(0.0f);
+  for (size_t i = 0; i < TAPS; i += 8) {
+    acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+    acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+  }
+  const float32x4_t sum = vaddq_f32(acc0, acc1);
+  return (vgetq_lane_f32(sum, 0) + vgetq_lane_f32(sum, 1)) +
+         (vgetq_lane_f32(sum, 2) + vgetq_lane_f32(sum, 3));
+#else
+  float sum = 0.0f;
+  for (size_t i = 0; i < TAPS; ++i) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+#endif
+}
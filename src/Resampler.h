@@ -0,0 +1,62 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+        Streaming Polyphase Resampler
+
+        Converts a mono float stream by the rational factor L/M (reduced from
+   outputRate/inputRate) so the analyzer always sees the same rate, whatever
+   the file or device runs at.
+
+        * A windowed-sinc prototype is designed once for L * TAPS points and
+   split into L phases of TAPS coefficients. Each output sample is one dot
+   product of a phase against the newest TAPS input samples, vectorized with
+   SSE or NEON where available.
+        * The cutoff sits at the lower of the two Nyquist frequencies, so
+   downsampling (e.g. 96k -> 48k) is anti-aliased.
+        * State carries across Process() calls; input can arrive in any chunk
+   size. Equal rates bypass the filter entirely.
+*/
+
+class Resampler {
+public:
+  constexpr static size_t TAPS = 32;
+
+  Resampler() = default;
+  Resampler(const Resampler &) = delete;
+  Resampler(Resampler &&) = delete;
+  Resampler &operator=(const Resampler &) = delete;
+  Resampler &operator=(Resampler &&) = delete;
+  ~Resampler() = default;
+
+  void Configure(uint32_t inputRate, uint32_t outputRate);
+  void Reset();
+
+  // Consumes all of in and appends every output sample it produces to out.
+  void Process(const float *in, size_t inCount, std::vector<float> &out);
+
+  // Input samples needed to produce outCount more output samples.
+  size_t InputNeeded(size_t outCount) const;
+
+  bool IsBypass() const { return this->up == this->down; }
+  uint32_t Up() const { return this->up; }
+  uint32_t Down() const { return this->down; }
+
+private:
+  static float Dot(const float *a, const float *b);
+
+  uint32_t up{1};
+  uint32_t down{1};
+
+  // phase-major, each phase reversed so it lines up with the input window
+  std::vector<float> coefficients;
+  std::vector<float> history;
+  size_t index{TAPS - 1};
+  uint32_t phase{0};
+};
+
+#endif
@@ -1,13 +1,52 @@
 #include "RingBuffer.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 size_t RingBuffer::GetAvailable() const {
   return mask(this->write.load() - this->read.load());
 }
+bool RingBuffer::WaitForAvailable(const size_t n,
+                                  const std::chrono::nanoseconds timeout) {
+  if (GetAvailable() >= n) {
+    return true;
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  this->wakeThreshold.store(n, std::memory_order_relaxed);
+
+  while (true) {
+    const uint32_t key = this->dataReady.PrepareWait();
+    if (GetAvailable() >= n) {
+      this->dataReady.CancelWait();
+      return true;
+    }
+
+    const auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::nanoseconds::zero()) {
+      this->dataReady.CancelWait();
+      return false;
+    }
+    this->dataReady.Wait(key, remaining);
+  }
+}
+
+RingBuffer::Stats RingBuffer::GetStats() const {
+  Stats stats;
+  stats.overruns = this->overruns.load(std::memory_order_relaxed);
+  stats.underruns = this->underruns.load(std::memory_order_relaxed);
+  stats.highWater = this->highWater.load(std::memory_order_relaxed);
+  stats.samplesPushed = this->samplesPushed.load(std::memory_order_relaxed);
+  stats.samplesPopped = this->samplesPopped.load(std::memory_order_relaxed);
+  stats.samplesFlushed = this->samplesFlushed.load(std::memory_order_relaxed);
+  return stats;
+}
+
 bool RingBuffer::PopFront(float &val) {
   if (this->nextRead == this->localWrite) {
     const size_t actualWrite = this->write.load(std::memory_order_acquire);
     if (this->nextRead == actualWrite) {
+      bump(this->underruns, 1);
       return false;
     }
 
@@ -19,8 +58,7 @@ bool RingBuffer::PopFront(float &val) {
   ++this->rBatch;
 
   if (this->rBatch >= BATCH_SIZE) {
-    this->read.store(this->nextRead, std::memory_order_release);
-    rBatch = 0;
+    publishRead();
   }
   return true;
 }
@@ -31,6 +69,7 @@ bool RingBuffer::PushBack(const float val) {
   if (afterNextWrite == this->localRead) {
     const size_t actualRead = this->read.load(std::memory_order_acquire);
     if (afterNextWrite == actualRead) {
+      bump(this->overruns, 1);
       return false;
     }
     this->localRead = actualRead;
@@ -41,12 +80,129 @@ bool RingBuffer::PushBack(const float val) {
   ++this->wBatch;
 
   if (wBatch >= BATCH_SIZE) {
-    this->write.store(nextWrite, std::memory_order_release);
-    wBatch = 0;
+    publishWrite();
   }
   return true;
 }
 
+size_t RingBuffer::PushBulk(const float *src, const size_t count) {
+  size_t space = mask(this->localRead - this->nextWrite - 1);
+  if (space < count) {
+    this->localRead = this->read.load(std::memory_order_acquire);
+    space = mask(this->localRead - this->nextWrite - 1);
+  }
+
+  const size_t n = count < space ? count : space;
+  const size_t first = std::min(n, BUFFER_SIZE - this->nextWrite);
+  std::memcpy(&this->data[this->nextWrite], src, first * sizeof(float));
+  std::memcpy(&this->data[0], src + first, (n - first) * sizeof(float));
+
+  this->nextWrite = mask(this->nextWrite + n);
+  this->wBatch += n;
+  if (n < count) {
+    bump(this->overruns, count - n);
+  }
+  if (this->wBatch > 0) {
+    publishWrite();
+  }
+  return n;
+}
+
+size_t RingBuffer::PopBulk(float *dst, const size_t count) {
+  size_t filled = mask(this->localWrite - this->nextRead);
+  if (filled < count) {
+    this->localWrite = this->write.load(std::memory_order_acquire);
+    filled = mask(this->localWrite - this->nextRead);
+  }
+
+  const size_t n = count < filled ? count : filled;
+  const size_t first = std::min(n, BUFFER_SIZE - this->nextRead);
+  std::memcpy(dst, &this->data[this->nextRead], first * sizeof(float));
+  std::memcpy(dst + first, &this->data[0], (n - first) * sizeof(float));
+
+  this->nextRead = mask(this->nextRead + n);
+  this->rBatch += n;
+  if (n < count) {
+    bump(this->underruns, count - n);
+  }
+  if (this->rBatch > 0) {
+    publishRead();
+  }
+  return n;
+}
+
+void RingBuffer::RequestFlush() {
+  if (this->wBatch > 0) {
+    publishWrite();
+  }
+  // samplesPushed is only written by this thread, so it is exact here
+  this->flushMark.store(this->samplesPushed.load(std::memory_order_relaxed),
+                        std::memory_order_release);
+  this->flushRequests.store(
+      this->flushRequests.load(std::memory_order_relaxed) + 1,
+      std::memory_order_release);
+}
+
+bool RingBuffer::TakeFlush(size_t &discarded) {
+  discarded = 0;
+  const uint64_t requests = this->flushRequests.load(std::memory_order_acquire);
+  if (requests == this->flushesTaken) {
+    return false;
+  }
+  this->flushesTaken = requests;
+
+  // the mark's release store follows the publish of every sample before it,
+  // so all of them are visible once the mark is
+  const uint64_t mark = this->flushMark.load(std::memory_order_acquire);
+  const uint64_t consumed =
+      this->samplesPopped.load(std::memory_order_relaxed) + this->rBatch;
+  if (mark <= consumed) {
+    return true;
+  }
+
+  this->localWrite = this->write.load(std::memory_order_acquire);
+  const size_t filled = mask(this->localWrite - this->nextRead);
+  discarded = static_cast<size_t>(std::min<uint64_t>(mark - consumed, filled));
+
+  this->nextRead = mask(this->nextRead + discarded);
+  this->rBatch += discarded;
+  bump(this->samplesFlushed, discarded);
+  publishRead();
+  return true;
+}
+
+void RingBuffer::publishRead() {
+  this->read.store(this->nextRead, std::memory_order_release);
+  bump(this->samplesPopped, rBatch);
+  rBatch = 0;
+}
+
+void RingBuffer::publishWrite() {
+  this->write.store(nextWrite, std::memory_order_release);
+  bump(this->samplesPushed, wBatch);
+  wBatch = 0;
+
+  // occupancy seen by the producer at publish time
+  const size_t used =
+      mask(nextWrite - this->read.load(std::memory_order_relaxed));
+  if (used > this->highWater.load(std::memory_order_relaxed)) {
+    this->highWater.store(used, std::memory_order_relaxed);
+  }
+
+  // only pay for a wake syscall when a consumer is actually asleep
+  if (this->dataReady.HasWaiters() &&
+      used >= this->wakeThreshold.load(std::memory_order_relaxed)) {
+    this->dataReady.NotifyAll();
+  }
+}
+
+// Counters have a single writer, so a plain load/store pair avoids the
+// locked read-modify-write of fetch_add on the hot path.
+void RingBuffer::bump(std::atomic<uint64_t> &counter, const uint64_t amount) {
+  counter.store(counter.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+}
+
 size_t RingBuffer::inc(const size_t val) const { return mask(val + 1); }
 
 size_t RingBuffer::mask(const size_t val) const {
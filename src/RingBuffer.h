@@ -4,12 +4,27 @@
 #include <__new/interference_size.h>
 #include <array>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "EventCount.h"
 
 class RingBuffer {
 public:
   constexpr static unsigned BUFFER_SIZE = 1 << 15;
+  // publish interval of the single-sample PushBack/PopFront paths
   constexpr static int BATCH_SIZE = 128;
 
+  /* Telemetry snapshot, readable from any thread */
+  struct Stats {
+    uint64_t overruns{0};
+    uint64_t underruns{0};
+    size_t highWater{0};
+    uint64_t samplesPushed{0};
+    uint64_t samplesPopped{0};
+    uint64_t samplesFlushed{0};
+  };
+
   RingBuffer() = default;
   RingBuffer(const RingBuffer &) = delete;
   RingBuffer(RingBuffer &&) = delete;
@@ -19,26 +34,61 @@ public:
 
   bool PushBack(float val);
   bool PopFront(float &val);
+
+  /* Copy up to count samples in one go and publish immediately.
+     Return the number of samples actually transferred. */
+  size_t PushBulk(const float *src, size_t count);
+  size_t PopBulk(float *dst, size_t count);
   size_t GetAvailable() const;
+  Stats GetStats() const;
+
+  /* Flush without touching the other side's index: the producer marks
+     everything it has pushed so far as stale, and the consumer drops the
+     stale samples the next time it calls TakeFlush(). Returns whether a
+     flush was taken and how many samples it discarded. */
+  void RequestFlush();
+  bool TakeFlush(size_t &discarded);
+
+  /* Consumer side: sleep until at least n samples are published or the
+     timeout expires. Returns whether n samples are available. */
+  bool WaitForAvailable(size_t n, std::chrono::nanoseconds timeout);
 
 private:
   size_t inc(size_t val) const;
   size_t mask(size_t val) const;
+  void publishRead();
+  void publishWrite();
+  static void bump(std::atomic<uint64_t> &counter, uint64_t amount);
 
   alignas(std::hardware_destructive_interference_size) std::atomic<size_t> read{
       0};
   alignas(
       std::hardware_destructive_interference_size) std::atomic<size_t> write{0};
 
+  /*Consumer Wakeup*/
+  alignas(std::hardware_destructive_interference_size) EventCount dataReady;
+  std::atomic<size_t> wakeThreshold{0};
+
+  /*Flush Handshake*/
+  std::atomic<uint64_t> flushMark{0};
+  std::atomic<uint64_t> flushRequests{0};
+
   /*Consumer Local Variables*/
   alignas(std::hardware_destructive_interference_size) size_t localWrite{0};
   size_t nextRead{0};
   size_t rBatch{0};
+  std::atomic<uint64_t> underruns{0};
+  std::atomic<uint64_t> samplesPopped{0};
+  std::atomic<uint64_t> samplesFlushed{0};
+  uint64_t flushesTaken{0};
 
   /*Producer Local Variables*/
   alignas(std::hardware_destructive_interference_size) size_t localRead{0};
   size_t nextWrite{0};
   size_t wBatch{0};
+  std::atomic<uint64_t> overruns{0};
+  std::atomic<uint64_t> samplesPushed{0};
+  std::atomic<size_t> highWater{0};
 
   /*Constant variables*/
   alignas(std::hardware_destructive_interference_size)
@@ -0,0 +1,97 @@
+#include "SnapshotBenchmark.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "AnalysisFrame.h"
+#include "Clock.h"
+#include "SnapshotChannel.h"
+
+namespace {
+// float holds every integer up to 2^24 exactly
+constexpr uint64_t VALUE_MASK = (1u << 24) - 1;
+
+void Fill(AnalysisFrame &frame, const uint64_t version) {
+  frame.sequence = version;
+  frame.samplePosition = version;
+  for (size_t i = 0; i < frame.spectrum.size(); ++i) {
+    frame.spectrum[i] = static_cast<float>((version + i) & VALUE_MASK);
+  }
+}
+
+bool Intact(const AnalysisFrame &frame) {
+  if (frame.samplePosition != frame.sequence) {
+    return false;
+  }
+  for (size_t i = 0; i < frame.spectrum.size(); ++i) {
+    if (frame.spectrum[i] !=
+        static_cast<float>((frame.sequence + i) & VALUE_MASK)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+SnapshotBenchmark::Row RunWithReaders(const int readerCount,
+                                      const uint64_t publishes) {
+  SnapshotChannel<AnalysisFrame> channel;
+  std::atomic<bool> done{false};
+  std::vector<int64_t> readNs(readerCount, 0);
+  std::vector<uint64_t> reads(readerCount, 0);
+  std::vector<uint64_t> torn(readerCount, 0);
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < readerCount; ++r) {
+    readers.emplace_back([&, r] {
+      const auto frame = std::make_unique<AnalysisFrame>();
+      while (!done.load(std::memory_order_acquire)) {
+        const int64_t startNs = NowNanos();
+        const uint64_t version = channel.Read(*frame);
+        readNs[r] += NowNanos() - startNs;
+        ++reads[r];
+        if (version != 0 && !Intact(*frame)) {
+          ++torn[r];
+        }
+      }
+    });
+  }
+
+  const auto frame = std::make_unique<AnalysisFrame>();
+  int64_t publishNs = 0;
+  for (uint64_t version = 1; version <= publishes; ++version) {
+    Fill(*frame, version);
+    const int64_t startNs = NowNanos();
+    channel.Publish(*frame);
+    publishNs += NowNanos() - startNs;
+  }
+  done.store(true, std::memory_order_release);
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+
+  SnapshotBenchmark::Row row;
+  row.readers = readerCount;
+  row.publishNs =
+      static_cast<double>(publishNs) / static_cast<double>(publishes);
+  int64_t totalReadNs = 0;
+  for (int r = 0; r < readerCount; ++r) {
+    totalReadNs += readNs[r];
+    row.reads += reads[r];
+    row.torn += torn[r];
+  }
+  row.readNs = row.reads == 0 ? 0.0
+                              : static_cast<double>(totalReadNs) /
+                                    static_cast<double>(row.reads);
+  return row;
+}
+} // namespace
+
+std::vector<SnapshotBenchmark::Row>
+SnapshotBenchmark::Run(const Settings &settings) {
+  std::vector<Row> rows;
+  for (const int readerCount : settings.readerCounts) {
+    rows.push_back(RunWithReaders(readerCount, settings.publishes));
+  }
+  return rows;
+}
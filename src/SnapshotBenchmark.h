@@ -0,0 +1,35 @@
+#ifndef SNAPSHOT_BENCHMARK_H
+#define SNAPSHOT_BENCHMARK_H
+
+#include <cstdint>
+#include <vector>
+
+/*
+        Snapshot Channel Benchmark
+
+        Publishes AnalysisFrame-sized values through a SnapshotChannel as
+   fast as possible while 1, 2, 4 and 8 readers copy them out, and reports
+   how the cost of a publish and of a read grows with the reader count.
+   Every value carries its version in all of its words, so a read that
+   returns a torn copy is counted rather than averaged in.
+*/
+
+class SnapshotBenchmark {
+public:
+  struct Settings {
+    uint64_t publishes{200000};
+    std::vector<int> readerCounts{1, 2, 4, 8};
+  };
+
+  struct Row {
+    int readers{0};
+    double publishNs{0.0};
+    double readNs{0.0};
+    uint64_t reads{0};
+    uint64_t torn{0};
+  };
+
+  static std::vector<Row> Run(const Settings &settings);
+};
+
+#endif
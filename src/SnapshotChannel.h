@@ -0,0 +1,111 @@
+#ifndef SNAPSHOT_CHANNEL_H
+#define SNAPSHOT_CHANNEL_H
+
+#include <__new/interference_size.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+/*
+        Seqlock Snapshot Channel for Many Readers
+
+        The TripleBuffer hands its staged slot to exactly one consumer. This
+   channel instead publishes the latest value so any number of readers can
+   copy it; the audio callback publishes its PlaybackClock this way for the
+   render loop and the transport controls.
+
+        Writer:
+        * bumps the sequence to odd, writes the payload, bumps it to even.
+        * never waits for readers.
+
+        Readers:
+        * copy the payload between two sequence loads and retry if the
+   sequence was odd or changed, i.e. the copy may have been torn.
+        * the returned version (sequence / 2) tells a reader whether it has
+   already seen this value.
+
+        The payload is stored as relaxed atomic words, which compile to plain
+   loads and stores, so the intentional read/write overlap is not a data
+   race in the C++ memory model.
+*/
+
+template <typename T> class SnapshotChannel {
+public:
+  static_assert(std::is_trivially_copyable_v<T>,
+                "snapshot payload is copied word by word");
+
+  SnapshotChannel() = default;
+  SnapshotChannel(const SnapshotChannel &) = delete;
+  SnapshotChannel(SnapshotChannel &&) = delete;
+  SnapshotChannel &operator=(const SnapshotChannel &) = delete;
+  SnapshotChannel &operator=(SnapshotChannel &&) = delete;
+  ~SnapshotChannel() = default;
+
+  /*Writer (single thread)*/
+  void Publish(const T &value) {
+    Words staging{};
+    std::memcpy(staging.data(), &value, sizeof(T));
+
+    const uint64_t seq = this->sequence.load(std::memory_order_relaxed);
+    this->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < WORD_COUNT; ++i) {
+      this->words[i].store(staging[i], std::memory_order_relaxed);
+    }
+
+    this->sequence.store(seq + 2, std::memory_order_release);
+  }
+
+  /*Readers (any thread)*/
+  // Returns the version copied into out, 0 if nothing was published yet.
+  uint64_t Read(T &out) const {
+    Words staging;
+    while (true) {
+      const uint64_t before = this->sequence.load(std::memory_order_acquire);
+      if (before & 1) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      for (size_t i = 0; i < WORD_COUNT; ++i) {
+        staging[i] = this->words[i].load(std::memory_order_relaxed);
+      }
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (this->sequence.load(std::memory_order_relaxed) == before) {
+        std::memcpy(static_cast<void *>(&out), staging.data(), sizeof(T));
+        return before / 2;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  // Copies only when a newer version than lastSeen is available.
+  bool ReadIfNewer(T &out, uint64_t &lastSeen) const {
+    if (Version() <= lastSeen) {
+      return false;
+    }
+    lastSeen = Read(out);
+    return true;
+  }
+
+  uint64_t Version() const {
+    return this->sequence.load(std::memory_order_acquire) / 2;
+  }
+
+private:
+  constexpr static size_t WORD_COUNT =
+      (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+  using Words = std::array<uint64_t, WORD_COUNT>;
+
+  alignas(std::hardware_destructive_interference_size)
+      std::atomic<uint64_t> sequence{0};
+  alignas(std::hardware_destructive_interference_size)
+      std::array<std::atomic<uint64_t>, WORD_COUNT> words{};
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "SpectralCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+using namespace Constants;
+
+namespace {
+constexpr char MAGIC[4] = {'A', 'V', 'S', 'C'};
+} // namespace
+
+std::string SpectralCache::PathFor(const std::string &audioPath) {
+  return audioPath + ".avsc";
+}
+
+TrackAnalyzer::Result
+SpectralCache::Build(TrackAnalyzer &analyzer, const std::string &audioPath,
+                     const std::string &cachePath,
+                     const TrackAnalyzer::Settings &settings,
+                     const uint32_t bitsPerValue) {
+  std::ofstream out(cachePath, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    std::cerr << "Could not create " << cachePath << '\n';
+    return {};
+  }
+
+  // placeholder, rewritten once the frame count is known
+  Header header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.hopSize = HOP_SIZE;
+  header.fftSize = FFT_SIZE;
+  header.bucketCount = BUCKET_COUNT;
+  header.bitsPerValue = bitsPerValue;
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  SpectrumAnalyzer::Buckets buckets{};
+  std::vector<uint8_t> frame(BUCKET_COUNT * (bitsPerValue / 8));
+  const float scale = bitsPerValue == 16 ? 65535.0f : 255.0f;
+
+  const TrackAnalyzer::Result result = analyzer.Run(
+      audioPath, settings, [&](const SpectrumAnalyzer::Spectrum &spectrum) {
+        SpectrumAnalyzer::ReduceToBuckets(spectrum, buckets);
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+          const auto q = static_cast<uint32_t>(
+              std::lround(std::clamp(buckets[i], 0.0f, 1.0f) * scale));
+          if (bitsPerValue == 16) {
+            const auto v = static_cast<uint16_t>(q);
+            std::memcpy(&frame[i * 2], &v, sizeof(v));
+          } else {
+            frame[i] = static_cast<uint8_t>(q);
+          }
+        }
+        out.write(reinterpret_cast<const char *>(frame.data()),
+                  static_cast<std::streamsize>(frame.size()));
+      });
+
+  if (!result.ok) {
+    out.close();
+    std::remove(cachePath.c_str());
+    return result;
+  }
+
+  header.sourceRate = result.sourceRate;
+  header.analysisRate = result.analysisRate;
+  header.sourceFrames = result.sourceFrames;
+  header.frameCount = result.hops;
+  out.seekp(0);
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  if (!out) {
+    std::cerr << "Could not write " << cachePath << '\n';
+    return {};
+  }
+  return result;
+}
+
+bool SpectralCache::Open(const std::string &path) {
+  this->Close();
+  if (!this->file.Open(path) || this->file.size() < sizeof(Header)) {
+    std::cerr << "Could not open spectral cache " << path << '\n';
+    this->file.Close();
+    return false;
+  }
+
+  std::memcpy(&this->header_, this->file.data(), sizeof(Header));
+  const Header &h = this->header_;
+  const bool layoutMatches =
+      std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+      h.version == VERSION && h.hopSize == HOP_SIZE &&
+      h.fftSize == FFT_SIZE && h.bucketCount == BUCKET_COUNT &&
+      (h.bitsPerValue == 8 || h.bitsPerValue == 16) && h.sourceRate != 0 &&
+      h.analysisRate != 0 && h.frameCount != 0;
+  const uint64_t frameBytes =
+      uint64_t{h.bucketCount} * (h.bitsPerValue / 8) * h.frameCount;
+  if (!layoutMatches || this->file.size() - sizeof(Header) < frameBytes) {
+    std::cerr << path << " is not a spectral cache for this build, "
+              << "rebuild it with --precompute\n";
+    this->file.Close();
+    return false;
+  }
+
+  this->frames_ = this->file.data() + sizeof(Header);
+  return true;
+}
+
+void SpectralCache::Close() {
+  this->frames_ = nullptr;
+  this->file.Close();
+}
+
+size_t SpectralCache::FrameAt(const uint64_t sourceFrame) const {
+  const Header &h = this->header_;
+  const uint64_t position =
+      h.sourceFrames != 0 ? sourceFrame % h.sourceFrames : sourceFrame;
+  const uint64_t analysisFrame = position * h.analysisRate / h.sourceRate;
+
+  // hop k covers analysis samples up to (k + 1) * HOP_SIZE
+  const uint64_t hop = analysisFrame / h.hopSize;
+  return static_cast<size_t>(std::min<uint64_t>(hop == 0 ? 0 : hop - 1,
+                                                h.frameCount - 1));
+}
+
+void SpectralCache::Read(const size_t frame,
+                         SpectrumAnalyzer::Buckets &buckets) const {
+  if (this->header_.bitsPerValue == 16) {
+    const uint8_t *src = this->frames_ + frame * BUCKET_COUNT * 2;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+      uint16_t v;
+      std::memcpy(&v, src + i * 2, sizeof(v));
+      buckets[i] = static_cast<float>(v) * (1.0f / 65535.0f);
+    }
+  } else {
+    const uint8_t *src = this->frames_ + frame * BUCKET_COUNT;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+      buckets[i] = static_cast<float>(src[i]) * (1.0f / 255.0f);
+    }
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef SPECTRAL_CACHE_H
+#define SPECTRAL_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "MappedFile.h"
+#include "SpectrumAnalyzer.h"
+#include "TrackAnalyzer.h"
+
+/*
+        Spectral Cache File
+
+        Precomputed visual bars for one track, so a known track can be shown
+   without decoding and FFTing it again.
+
+        Layout (little-endian), memory-mapped for playback:
+        * Header: magic "AVSC", format version, the source and analysis
+   rates, hop/FFT size, bucket count, bits per value and frame counts.
+        * frameCount frames of bucketCount values each, quantized to uint8 or
+   uint16 over the 0..1 bar range, one frame per analysis hop.
+
+        Readers reject a cache whose hop, FFT or bucket layout differs from
+   this build's, since the frames would no longer line up with the bars.
+*/
+
+class SpectralCache {
+public:
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t sourceRate;
+    uint32_t analysisRate;
+    uint32_t hopSize;
+    uint32_t fftSize;
+    uint32_t bucketCount;
+    uint32_t bitsPerValue;
+    uint64_t sourceFrames;
+    uint64_t frameCount;
+  };
+  static_assert(sizeof(Header) == 48, "cache header is written verbatim");
+
+  constexpr static uint32_t VERSION = 1;
+
+  SpectralCache() = default;
+  SpectralCache(const SpectralCache &) = delete;
+  SpectralCache(SpectralCache &&) = delete;
+  SpectralCache &operator=(const SpectralCache &) = delete;
+  SpectralCache &operator=(SpectralCache &&) = delete;
+  ~SpectralCache() = default;
+
+  static std::string PathFor(const std::string &audioPath);
+
+  // Analyzes audioPath and writes its cache; bitsPerValue is 8 or 16.
+  static TrackAnalyzer::Result Build(TrackAnalyzer &analyzer,
+                                     const std::string &audioPath,
+                                     const std::string &cachePath,
+                                     const TrackAnalyzer::Settings &settings,
+                                     uint32_t bitsPerValue);
+
+  bool Open(const std::string &path);
+  void Close();
+
+  // Frame whose newest sample is at or before the given source position.
+  // Positions past the end wrap, matching looped playback.
+  [[nodiscard]] size_t FrameAt(uint64_t sourceFrame) const;
+  void Read(size_t frame, SpectrumAnalyzer::Buckets &buckets) const;
+
+  [[nodiscard]] const Header &header() const { return header_; }
+  [[nodiscard]] bool isOpen() const { return frames_ != nullptr; }
+
+private:
+  MappedFile file;
+  Header header_{};
+  const uint8_t *frames_{nullptr};
+};
+
+#endif
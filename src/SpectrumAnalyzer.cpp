@@ -0,0 +1,120 @@
+#include "SpectrumAnalyzer.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace Constants;
+
+SpectrumAnalyzer::SpectrumAnalyzer() {
+  for (int i = 0; i < FFT_SIZE; ++i) {
+    this->mHannTable[i] =
+        0.54f - 0.46f * cosf(2.0f * PI * static_cast<float>(i) /
+                             static_cast<float>(FFT_SIZE - 1));
+  }
+}
+
+void SpectrumAnalyzer::Reset() { this->samples.fill(0); }
+
+void SpectrumAnalyzer::PushHop(const float *hop) {
+  // move window HOP_SIZE items over
+  std::copy(this->samples.begin() + HOP_SIZE, this->samples.end(),
+            this->samples.begin());
+
+  constexpr size_t writeIndex = FFT_SIZE - HOP_SIZE;
+  for (int i = 0; i < HOP_SIZE; ++i) {
+    this->samples[writeIndex + i] = {hop[i], 0};
+  }
+}
+
+// Cooley-Turkey FFT
+// (in-place, breadth-first, decimation-in-frequency)
+// Taken from rosettacode.org
+// https://rosettacode.org/wiki/Fast_Fourier_transform#C.2B.2B
+void SpectrumAnalyzer::fft(ComplexArray &d) {
+  // DFT
+  unsigned int N = d.size(), k = N, n;
+  double thetaT = 3.14159265358979323846264338328L / N;
+  ComplexValue phiT = ComplexValue(cos(thetaT), -sin(thetaT)), T;
+  while (k > 1) {
+    n = k;
+    k >>= 1;
+    phiT = phiT * phiT;
+    T = 1.0L;
+    for (unsigned int l = 0; l < k; l++) {
+      for (unsigned int a = l; a < N; a += n) {
+        unsigned int b = a + k;
+        ComplexValue t = d[a] - d[b];
+        d[a] += d[b];
+        d[b] = t * T;
+      }
+      T *= phiT;
+    }
+  }
+  // Decimate
+  unsigned int m = (unsigned int)log2(N);
+  for (unsigned int a = 0; a < N; a++) {
+    unsigned int b = a;
+    // Reverse bits
+    b = (((b & 0xaaaaaaaa) >> 1) | ((b & 0x55555555) << 1));
+    b = (((b & 0xcccccccc) >> 2) | ((b & 0x33333333) << 2));
+    b = (((b & 0xf0f0f0f0) >> 4) | ((b & 0x0f0f0f0f) << 4));
+    b = (((b & 0xff00ff00) >> 8) | ((b & 0x00ff00ff) << 8));
+    b = ((b >> 16) | (b << 16)) >> (32 - m);
+    if (b > a) {
+      ComplexValue t = d[a];
+      d[a] = d[b];
+      d[b] = t;
+    }
+  }
+  // Normalize
+  ComplexValue f = 1.0 / sqrt(N);
+  for (unsigned int i = 0; i < N; i++)
+    d[i] *= f;
+}
+
+void SpectrumAnalyzer::ApplyHanning() {
+  for (int i = 0; i < FFT_SIZE; ++i) {
+    this->fftData[i] *= this->mHannTable[i];
+  }
+}
+
+void SpectrumAnalyzer::Compute(Spectrum &spectrum) {
+  this->fftData = ComplexArray(this->samples.data(), FFT_SIZE);
+  this->ApplyHanning();
+  fft(this->fftData);
+
+  constexpr float dbFloor = 60.0f;
+  constexpr float invRange = 1.0f / dbFloor;
+  constexpr float dbAdd = dbFloor;
+
+  const size_t binCount = this->fftData.size() / 2;
+  for (int i = 0; i < binCount; ++i) {
+    const auto squaredMag = static_cast<float>(std::norm(this->fftData[i]));
+    const float db = 10.0f * log10f(squaredMag + 1e-12f);
+    float normalized = (db + dbAdd) * invRange;
+    spectrum[i] = std::clamp(normalized, 0.0f, 1.0f);
+  }
+}
+
+void SpectrumAnalyzer::ReduceToBuckets(const Spectrum &spectrum,
+                                       Buckets &buckets) {
+  // bars are ordered by frequency, so the last one ends highest
+  constexpr size_t usedBins = BAR_BINS[BUCKET_COUNT - 1].end;
+  static_assert(usedBins <= AnalysisFrame::BIN_COUNT);
+
+  // prefix[i] = sum of bins [0, i); double so the high bars do not lose the
+  // precision of the low ones
+  std::array<double, usedBins + 1> prefix;
+  prefix[0] = 0.0;
+  for (size_t i = 0; i < usedBins; ++i) {
+    prefix[i + 1] = prefix[i] + spectrum[i];
+  }
+
+  for (int visualBar = 0; visualBar < BUCKET_COUNT; ++visualBar) {
+    const BarBins &bins = BAR_BINS[visualBar];
+    buckets[visualBar] =
+        static_cast<float>(prefix[bins.end] - prefix[bins.start]) *
+        bins.invCount;
+  }
+}
@@ -0,0 +1,120 @@
+#ifndef SPECTRUM_ANALYZER_H
+#define SPECTRUM_ANALYZER_H
+
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <valarray>
+
+#include "AnalysisFrame.h"
+#include "constants.h"
+
+typedef std::complex<double> ComplexValue;
+typedef std::valarray<ComplexValue> ComplexArray;
+
+/*
+        Spectrum Analyzer
+
+        The FFT stage shared by the live AnalyzerThread and the offline tools
+   (cache precompute, batch features). Owns the sliding FFT_SIZE window; each
+   PushHop() shifts in HOP_SIZE new samples and Compute() produces the
+   normalized (0..1, 60 dB range) magnitude spectrum of the current window.
+
+        ReduceToBuckets() folds a spectrum into the BUCKET_COUNT visual bars
+   the renderer draws, so cached frames and live frames use the same mapping.
+   Bar b averages bins [start, end) with start = (b / BUCKET_COUNT)^2.5 of
+   the lower 80% of the spectrum; the ranges depend only on the constants,
+   so BAR_BINS is built at compile time and each bar's mean is a difference
+   of two prefix sums.
+*/
+
+// Bins [start, end) averaged into one visual bar
+struct BarBins {
+  uint16_t start{0};
+  uint16_t end{0};
+  float invCount{0.0f};
+};
+using BarTable = std::array<BarBins, Constants::BUCKET_COUNT>;
+
+// sqrt by Newton's method, for tables built at compile time
+constexpr double const_sqrt(const double x) {
+  if (x <= 0.0) {
+    return 0.0;
+  }
+  double guess = x < 1.0 ? 1.0 : x;
+  for (int i = 0; i < 64; ++i) {
+    const double next = 0.5 * (guess + x / guess);
+    if (next == guess) {
+      break;
+    }
+    guess = next;
+  }
+  return guess;
+}
+
+constexpr BarTable GenerateBarTable() {
+  constexpr float maxFreqCrop = 0.8f;
+  constexpr float numBins =
+      static_cast<float>(AnalysisFrame::BIN_COUNT) * maxFreqCrop;
+  constexpr int lastBin = static_cast<int>(numBins);
+
+  // t^2.5 rounded to float, as powf(t, 2.5f) returns it
+  auto curve = [](const float t) {
+    const auto d = static_cast<double>(t);
+    return static_cast<float>(d * d * const_sqrt(d));
+  };
+
+  BarTable table{};
+  for (int bar = 0; bar < Constants::BUCKET_COUNT; ++bar) {
+    const auto fBar = static_cast<float>(bar);
+    const float tStart = fBar / Constants::BUCKET_COUNT;
+    const float tEnd = (fBar + 1.0f) / Constants::BUCKET_COUNT;
+
+    int start = static_cast<int>(curve(tStart) * numBins);
+    int end = static_cast<int>(curve(tEnd) * numBins);
+    if (start < 2)
+      start = 2;
+    if (end <= start)
+      end = start + 1;
+    if (end > lastBin)
+      end = lastBin;
+
+    BarBins &bins = table[bar];
+    bins.start = static_cast<uint16_t>(start);
+    bins.end = static_cast<uint16_t>(end > start ? end : start);
+    bins.invCount = end > start ? 1.0f / static_cast<float>(end - start) : 0.0f;
+  }
+  return table;
+}
+
+class SpectrumAnalyzer {
+public:
+  using Spectrum = std::array<float, AnalysisFrame::BIN_COUNT>;
+  using Buckets = std::array<float, Constants::BUCKET_COUNT>;
+
+  SpectrumAnalyzer();
+  SpectrumAnalyzer(const SpectrumAnalyzer &) = delete;
+  SpectrumAnalyzer(SpectrumAnalyzer &&) = delete;
+  SpectrumAnalyzer &operator=(const SpectrumAnalyzer &) = delete;
+  SpectrumAnalyzer &operator=(SpectrumAnalyzer &&) = delete;
+  ~SpectrumAnalyzer() = default;
+
+  // hop must hold HOP_SIZE samples
+  void PushHop(const float *hop);
+  void Compute(Spectrum &spectrum);
+  void Reset();
+
+  static void ReduceToBuckets(const Spectrum &spectrum, Buckets &buckets);
+
+  static constexpr BarTable BAR_BINS = GenerateBarTable();
+
+private:
+  static void fft(ComplexArray &data);
+  void ApplyHanning();
+
+  std::array<ComplexValue, Constants::FFT_SIZE> samples = {0};
+  std::array<float, Constants::FFT_SIZE> mHannTable = {0.0f};
+  ComplexArray fftData;
+};
+
+#endif
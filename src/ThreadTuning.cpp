@@ -0,0 +1,156 @@
+#include "ThreadTuning.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+std::string FormatCpuList(const std::vector<int> &cpus) {
+  std::ostringstream out;
+  for (size_t i = 0; i < cpus.size();) {
+    size_t j = i;
+    while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+      ++j;
+    }
+    out << (i == 0 ? "" : ",") << cpus[i];
+    if (j > i) {
+      out << '-' << cpus[j];
+    }
+    i = j + 1;
+  }
+  return out.str();
+}
+
+#if defined(__linux__)
+pid_t CurrentTid() { return static_cast<pid_t>(syscall(SYS_gettid)); }
+
+std::string DescribeCurrent() {
+  std::ostringstream out;
+  int policy = 0;
+  sched_param param{};
+  pthread_getschedparam(pthread_self(), &policy, &param);
+  if (policy == SCHED_FIFO || policy == SCHED_RR) {
+    out << (policy == SCHED_FIFO ? "SCHED_FIFO " : "SCHED_RR ")
+        << param.sched_priority;
+  } else {
+    errno = 0;
+    const int nice = getpriority(PRIO_PROCESS, CurrentTid());
+    out << "SCHED_OTHER nice " << (errno == 0 ? nice : 0);
+  }
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+    out << ", cpus " << FormatCpuList(cpus);
+  }
+  return out.str();
+}
+#endif
+} // namespace
+
+std::string ThreadTuning::Apply(const std::string &threadName,
+                                const Settings &settings) {
+  std::ostringstream notes;
+
+#if defined(__linux__)
+  // 15 characters plus the terminator is the kernel's limit
+  pthread_setname_np(pthread_self(), threadName.substr(0, 15).c_str());
+  if (settings.IsDefault()) {
+    return {};
+  }
+
+  if (!settings.cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const int cpu : settings.cpus) {
+      if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &set);
+      }
+    }
+    const int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (error != 0) {
+      notes << "; affinity refused (" << std::strerror(error) << ')';
+    }
+  }
+
+  bool fifo = false;
+  if (settings.fifoPriority > 0) {
+    sched_param param{};
+    param.sched_priority = std::clamp(settings.fifoPriority,
+                                      sched_get_priority_min(SCHED_FIFO),
+                                      sched_get_priority_max(SCHED_FIFO));
+    const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (error == 0) {
+      fifo = true;
+    } else {
+      notes << "; SCHED_FIFO refused (" << std::strerror(error) << ')';
+    }
+  }
+
+  // nice only applies to time-sharing threads, so it is the fallback
+  if (!fifo && settings.niceLevel != 0) {
+    if (setpriority(PRIO_PROCESS, CurrentTid(), settings.niceLevel) != 0) {
+      notes << "; nice " << settings.niceLevel << " refused ("
+            << std::strerror(errno) << ')';
+    }
+  }
+
+  const std::string report = "Thread " + threadName + ": " +
+                             DescribeCurrent() + notes.str();
+#else
+  (void)notes;
+  if (settings.IsDefault()) {
+    return {};
+  }
+  const std::string report =
+      "Thread " + threadName +
+      ": affinity and scheduling options are only supported on Linux";
+#endif
+
+  // one write so reports from threads starting together do not interleave
+  std::cout << (report + '\n') << std::flush;
+  return report;
+}
+
+bool ThreadTuning::ParseCpuList(const std::string &text,
+                                std::vector<int> &cpus) {
+  cpus.clear();
+  std::istringstream in(text);
+  std::string item;
+  while (std::getline(in, item, ',')) {
+    try {
+      const size_t dash = item.find('-');
+      const int first = std::stoi(item.substr(0, dash));
+      const int last =
+          dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+      if (first < 0 || last < first) {
+        return false;
+      }
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    } catch (const std::exception &) {
+      return false;
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return !cpus.empty();
+}
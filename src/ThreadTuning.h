@@ -0,0 +1,50 @@
+#ifndef THREAD_TUNING_H
+#define THREAD_TUNING_H
+
+#include <string>
+#include <vector>
+
+/*
+        Thread Tuning
+
+        Per-thread CPU affinity and scheduling for the pipeline's own threads
+   (analyzer, decoder read-ahead, render loop, batch workers), so a loaded
+   machine does not preempt them in the middle of a hop or a frame.
+
+        * Apply() runs on the thread being tuned, at its start.
+        * Every step falls back instead of failing: SCHED_FIFO usually needs
+   CAP_SYS_NICE or an rtprio limit, so when it is refused the nice level is
+   tried instead, and a refused nice leaves the default policy.
+        * The report is read back from the kernel afterwards, so it shows
+   what the thread actually got rather than what was asked for.
+
+        Linux only; elsewhere Apply() names the thread and reports that
+   nothing was changed.
+*/
+
+class ThreadTuning {
+public:
+  struct Settings {
+    // CPUs to pin to; empty lets the scheduler place the thread
+    std::vector<int> cpus;
+    // SCHED_FIFO priority 1..99; 0 keeps time-sharing
+    int fifoPriority{0};
+    // nice level for time-sharing, also the fallback for a refused FIFO
+    int niceLevel{0};
+
+    [[nodiscard]] bool IsDefault() const {
+      return this->cpus.empty() && this->fifoPriority == 0 &&
+             this->niceLevel == 0;
+    }
+  };
+
+  // Tunes the calling thread and prints a one-line report unless settings
+  // are all defaults. Returns the report.
+  static std::string Apply(const std::string &threadName,
+                           const Settings &settings);
+
+  // "2", "0,2,4" or "0-3,6"
+  static bool ParseCpuList(const std::string &text, std::vector<int> &cpus);
+};
+
+#endif
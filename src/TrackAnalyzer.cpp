@@ -0,0 +1,56 @@
+#include "TrackAnalyzer.h"
+
+#include "Clock.h"
+#include "Denormals.h"
+
+using namespace Constants;
+
+TrackAnalyzer::Result TrackAnalyzer::Run(const std::string &path,
+                                         const Settings &settings,
+                                         const HopCallback &onHop) {
+  // runs on pool workers and the main thread; leave their mode as found
+  const ScopedNoDenormals noDenormals;
+  Result result;
+  if (!this->source.Open(path, settings.memoryMapping)) {
+    return result;
+  }
+
+  result.sourceRate = this->source.sampleRate();
+  result.analysisRate =
+      settings.analysisRate == 0 ? result.sourceRate : settings.analysisRate;
+  this->analysisRate = result.analysisRate;
+  this->resampler.Configure(result.sourceRate, result.analysisRate);
+  this->analyzer.Reset();
+  this->chunk.resize(CHUNK_FRAMES);
+  this->pending.clear();
+
+  while (true) {
+    const int64_t decodeStartNs = NowNanos();
+    const uint64_t framesRead =
+        this->source.Read(this->chunk.data(), CHUNK_FRAMES);
+    const int64_t analysisStartNs = NowNanos();
+    result.decodeNs += analysisStartNs - decodeStartNs;
+    if (framesRead == 0) {
+      break;
+    }
+    result.sourceFrames += framesRead;
+
+    this->resampler.Process(this->chunk.data(), framesRead, this->pending);
+
+    size_t offset = 0;
+    for (; offset + HOP_SIZE <= this->pending.size(); offset += HOP_SIZE) {
+      this->analyzer.PushHop(this->pending.data() + offset);
+      this->analyzer.Compute(this->spectrum);
+      onHop(this->spectrum);
+      ++result.hops;
+    }
+    this->pending.erase(this->pending.begin(),
+                        this->pending.begin() +
+                            static_cast<std::ptrdiff_t>(offset));
+    result.analysisNs += NowNanos() - analysisStartNs;
+  }
+
+  this->source.Close();
+  result.ok = true;
+  return result;
+}
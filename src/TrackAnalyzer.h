@@ -0,0 +1,71 @@
+#ifndef TRACK_ANALYZER_H
+#define TRACK_ANALYZER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Resampler.h"
+#include "SpectrumAnalyzer.h"
+#include "TrackSource.h"
+
+/*
+        Track Analyzer
+
+        Synchronous decode -> resample -> FFT of a whole file on the calling
+   thread, for tools that do not need playback (cache precompute, batch
+   feature extraction). Runs the same Resampler and SpectrumAnalyzer stages
+   as the live AnalyzerThread, so its hops match what the visualizer shows.
+
+        One instance per thread; Run() can be called repeatedly to reuse the
+   buffers across files.
+*/
+
+class TrackAnalyzer {
+public:
+  struct Settings {
+    // 0 analyzes at the file's own rate
+    uint32_t analysisRate{48000};
+    bool memoryMapping{true};
+  };
+
+  struct Result {
+    bool ok{false};
+    uint32_t sourceRate{0};
+    uint32_t analysisRate{0};
+    uint64_t sourceFrames{0};
+    uint64_t hops{0};
+    int64_t decodeNs{0};
+    int64_t analysisNs{0};
+  };
+
+  using HopCallback = std::function<void(const SpectrumAnalyzer::Spectrum &)>;
+
+  TrackAnalyzer() = default;
+  TrackAnalyzer(const TrackAnalyzer &) = delete;
+  TrackAnalyzer(TrackAnalyzer &&) = delete;
+  TrackAnalyzer &operator=(const TrackAnalyzer &) = delete;
+  TrackAnalyzer &operator=(TrackAnalyzer &&) = delete;
+  ~TrackAnalyzer() = default;
+
+  // Calls onHop with the spectrum of every complete hop in the file.
+  Result Run(const std::string &path, const Settings &settings,
+             const HopCallback &onHop);
+
+  // Analysis rate of the current file, valid from the first hop callback
+  [[nodiscard]] uint32_t AnalysisRate() const { return this->analysisRate; }
+
+private:
+  constexpr static uint64_t CHUNK_FRAMES = 4096;
+
+  uint32_t analysisRate{0};
+  TrackSource source;
+  Resampler resampler;
+  SpectrumAnalyzer analyzer;
+  SpectrumAnalyzer::Spectrum spectrum{};
+  std::vector<float> chunk;
+  std::vector<float> pending;
+};
+
+#endif
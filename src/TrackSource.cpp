@@ -0,0 +1,134 @@
+#include "TrackSource.h"
+
+TrackSource::~TrackSource() { this->Close(); }
+
+bool TrackSource::Open(const std::string &path, const bool allowMapping,
+                       const uint32_t outputSampleRate) {
+  this->Close();
+  const ma_decoder_config config =
+      ma_decoder_config_init(ma_format_f32, 1, outputSampleRate);
+
+  if (allowMapping && this->file.Open(path) &&
+      this->wav.Open(this->file.data(), this->file.size()) &&
+      (outputSampleRate == 0 || this->wav.sampleRate() == outputSampleRate)) {
+    this->sampleRate_ = this->wav.sampleRate();
+    this->path_ = Path::DirectWav;
+    return true;
+  }
+
+  // everything else is decoded from chunks fetched ahead, mapped or not; the
+  // mapping stays open only as the fallback
+  if (this->prefetch.Open(path)) {
+    if (ma_decoder_init(&TrackSource::onRead, &TrackSource::onSeek,
+                        &this->prefetch, &config,
+                        &this->decoder) == MA_SUCCESS) {
+      this->file.Close();
+      this->sampleRate_ = this->decoder.outputSampleRate;
+      this->path_ = Path::PrefetchDecoder;
+      return true;
+    }
+    this->prefetch.Close();
+  }
+
+  if (this->file.isOpen()) {
+    if (ma_decoder_init_memory(this->file.data(), this->file.size(), &config,
+                               &this->decoder) == MA_SUCCESS) {
+      this->sampleRate_ = this->decoder.outputSampleRate;
+      this->path_ = Path::MappedDecoder;
+      return true;
+    }
+    this->file.Close();
+  }
+
+  return this->OpenFileDecoder(path, outputSampleRate);
+}
+
+bool TrackSource::OpenFileDecoder(const std::string &path,
+                                  const uint32_t outputSampleRate) {
+  this->Close();
+  const ma_decoder_config config =
+      ma_decoder_config_init(ma_format_f32, 1, outputSampleRate);
+  if (ma_decoder_init_file(path.c_str(), &config, &this->decoder) ==
+      MA_SUCCESS) {
+    this->sampleRate_ = this->decoder.outputSampleRate;
+    this->path_ = Path::FileDecoder;
+    return true;
+  }
+  return false;
+}
+
+void TrackSource::Close() {
+  if (this->path_ == Path::PrefetchDecoder ||
+      this->path_ == Path::MappedDecoder || this->path_ == Path::FileDecoder) {
+    ma_decoder_uninit(&this->decoder);
+  }
+  this->prefetch.Close();
+  this->file.Close();
+  this->sampleRate_ = 0;
+  this->path_ = Path::None;
+}
+
+uint64_t TrackSource::Read(float *out, const uint64_t frames) {
+  if (this->path_ == Path::DirectWav) {
+    return this->wav.ReadFrames(out, static_cast<size_t>(frames));
+  }
+  if (this->path_ == Path::None) {
+    return 0;
+  }
+
+  ma_uint64 framesRead = 0;
+  ma_decoder_read_pcm_frames(&this->decoder, out, frames, &framesRead);
+  return framesRead;
+}
+
+bool TrackSource::SeekToFrame(const uint64_t frame) {
+  if (this->path_ == Path::DirectWav) {
+    return this->wav.SeekToFrame(frame);
+  }
+  if (this->path_ == Path::None) {
+    return false;
+  }
+  return ma_decoder_seek_to_pcm_frame(&this->decoder, frame) == MA_SUCCESS;
+}
+
+const char *TrackSource::PathName(const Path path) {
+  switch (path) {
+  case Path::DirectWav:
+    return "direct WAV (mmap)";
+  case Path::PrefetchDecoder:
+    return "decoder (prefetch)";
+  case Path::MappedDecoder:
+    return "decoder (mmap)";
+  case Path::FileDecoder:
+    return "decoder (stdio)";
+  default:
+    return "none";
+  }
+}
+
+PrefetchReader::Stats TrackSource::GetIoStats() const {
+  return this->path_ == Path::PrefetchDecoder ? this->prefetch.GetStats()
+                                              : PrefetchReader::Stats{};
+}
+
+PrefetchReader::Backend TrackSource::ioBackend() const {
+  return this->path_ == Path::PrefetchDecoder ? this->prefetch.backend()
+                                              : PrefetchReader::Backend::None;
+}
+
+ma_result TrackSource::onRead(ma_decoder *decoder, void *out,
+                              const size_t bytes, size_t *bytesRead) {
+  auto *reader = static_cast<PrefetchReader *>(decoder->pUserData);
+  const size_t n = reader->Read(out, bytes);
+  if (bytesRead) {
+    *bytesRead = n;
+  }
+  return n == 0 && bytes > 0 ? MA_AT_END : MA_SUCCESS;
+}
+
+ma_result TrackSource::onSeek(ma_decoder *decoder, const ma_int64 offset,
+                              const ma_seek_origin origin) {
+  auto *reader = static_cast<PrefetchReader *>(decoder->pUserData);
+  return reader->Seek(offset, static_cast<int>(origin)) ? MA_SUCCESS
+                                                        : MA_BAD_SEEK;
+}
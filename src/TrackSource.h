@@ -0,0 +1,75 @@
+#ifndef TRACK_SOURCE_H
+#define TRACK_SOURCE_H
+
+#include <cstdint>
+#include <string>
+
+#include "miniaudio.h"
+#include "MappedFile.h"
+#include "PrefetchReader.h"
+#include "WavReader.h"
+
+/*
+        Track Source
+
+        Produces the mono float PCM of one file, at its native sample rate
+   unless another output rate is requested.
+   Uncompressed 16/24-bit and float WAV data is memory-mapped and read
+   directly by WavReader. Everything else (and every WAV when mapping is
+   disabled) is decoded by ma_decoder reading through a PrefetchReader, so
+   the decoder copies from chunks that were fetched ahead instead of
+   blocking on the disk. If the prefetch reader cannot be set up, the mapped
+   image and then ma_decoder_init_file are the fallbacks.
+*/
+
+class TrackSource {
+public:
+  enum class Path {
+    None,
+    DirectWav,
+    PrefetchDecoder,
+    MappedDecoder,
+    FileDecoder
+  };
+
+  TrackSource() = default;
+  TrackSource(const TrackSource &) = delete;
+  TrackSource(TrackSource &&) = delete;
+  TrackSource &operator=(const TrackSource &) = delete;
+  TrackSource &operator=(TrackSource &&) = delete;
+  ~TrackSource();
+
+  // outputSampleRate 0 keeps the file's native rate, anything else
+  // resamples through the decoder
+  bool Open(const std::string &path, bool allowMapping = true,
+            uint32_t outputSampleRate = 0);
+  // Only the plain stdio decoder, as a baseline for the paths above.
+  bool OpenFileDecoder(const std::string &path,
+                       uint32_t outputSampleRate = 0);
+  void Close();
+
+  uint64_t Read(float *out, uint64_t frames);
+  bool SeekToFrame(uint64_t frame);
+
+  [[nodiscard]] uint32_t sampleRate() const { return sampleRate_; }
+  [[nodiscard]] Path path() const { return path_; }
+  [[nodiscard]] static const char *PathName(Path path);
+  // zeros unless the track is read through the prefetch path
+  [[nodiscard]] PrefetchReader::Stats GetIoStats() const;
+  [[nodiscard]] PrefetchReader::Backend ioBackend() const;
+
+private:
+  static ma_result onRead(ma_decoder *decoder, void *out, size_t bytes,
+                          size_t *bytesRead);
+  static ma_result onSeek(ma_decoder *decoder, ma_int64 offset,
+                          ma_seek_origin origin);
+
+  MappedFile file;
+  PrefetchReader prefetch;
+  WavReader wav;
+  ma_decoder decoder{};
+  uint32_t sampleRate_{0};
+  Path path_{Path::None};
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <cstdint>
+
+/*
+        Transport Messages
+
+        Plain messages passed through CommandQueues between the control
+   thread, the audio callback and the decoder read-ahead thread. Frames are
+   positions in the current track at the stream sample rate.
+
+        * TransportCommand: control thread -> callback; seeks and loop
+   regions are forwarded on to the read-ahead thread.
+        * StreamSegment: read-ahead thread -> callback; marks where the
+   decoded stream jumps, so the callback knows which source frame it is
+   playing.
+*/
+
+struct TransportCommand {
+  enum class Type : uint8_t { Seek, Pause, Resume, SetLoop, ClearLoop };
+
+  Type type{Type::Seek};
+  uint64_t start{0};
+  uint64_t end{0};
+};
+
+struct StreamSegment {
+  // the sample pushed at this position of the playback ring...
+  uint64_t ringPosition{0};
+  // ...is this frame of the current track
+  uint64_t sourceFrame{0};
+};
+
+#endif
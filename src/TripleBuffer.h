@@ -2,11 +2,11 @@
 #define TRIPLE_BUFFER_H
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
-#include <mutex>
 
 /*
-        Triple Buffer for Minimal-Contention Thread Communication
+        Triple Buffer for Wait-Free Thread Communication
 
         Problem with Double Buffering:
         In a standard double-buffer, if the Analyzer (Producer) finishes
@@ -17,24 +17,32 @@
         Triple Buffer Logic:
         * Analyzer (Thread A) works on private 'Write Buffer' (No Lock).
         * Visualizer (Thread B) works on private 'Read Buffer' (No Lock).
-        * Synchronization required on 'Staging Buffer', done by a mutex (Fine
-   Grained Locking).
-
-        Swap Logic (Critical Section):
-        * The Analyzer finishes processing the data and performs Swap (Staging
-   <---> Write).
-        * When the Visualizer finishes drawing and performs Swap (Staging <--->
-   Read).
-        * No resource contention, only adding a ns delay inside Swap (Critical
-   Section).
+        * The 'Staging Buffer' is a single atomic word holding the staged
+   buffer's address with a dirty bit packed into its low bit.
+
+        Swap Logic (Single Atomic Exchange):
+        * The Analyzer finishes processing the data and exchanges its Write
+   buffer into Staging, tagged dirty.
+        * The Visualizer checks the dirty bit and, if set, exchanges its Read
+   buffer into Staging, tagged clean.
+        * Neither side ever waits, and a consumer swap can no longer lose a
+   race against the producer and miss a fresh frame.
 */
 
 template <typename T> class TripleBuffer {
 public:
-  TripleBuffer(int size)
-      : newDataReady(false), sharedBuffer(std::make_unique<T>(size)),
-        producerWriteBuffer_(std::make_unique<T>(size)),
-        consumerReadBuffer_(std::make_unique<T>(size)) {}
+  template <typename... Args>
+  explicit TripleBuffer(const Args &...args)
+      : staged(pack(new T(args...), false)),
+        producerWriteBuffer_(std::make_unique<T>(args...)),
+        consumerReadBuffer_(std::make_unique<T>(args...)) {}
+
+  TripleBuffer(const TripleBuffer &) = delete;
+  TripleBuffer(TripleBuffer &&) = delete;
+  TripleBuffer &operator=(const TripleBuffer &) = delete;
+  TripleBuffer &operator=(TripleBuffer &&) = delete;
+
+  ~TripleBuffer() { delete unpack(staged.load(std::memory_order_acquire)); }
 
   std::unique_ptr<T> producerWriteBuffer() {
     return std::move(this->producerWriteBuffer_);
@@ -45,26 +53,39 @@ public:
   }
 
   void swapProducer(std::unique_ptr<T> &producerBuff) {
-    std::lock_guard lck(mtx);
-    std::swap(this->sharedBuffer, producerBuff);
-    newDataReady = true;
+    const uintptr_t previous = staged.exchange(
+        pack(producerBuff.release(), true), std::memory_order_acq_rel);
+    producerBuff.reset(unpack(previous));
   }
 
   bool swapConsumer(std::unique_ptr<T> &consumerBuff) {
-    std::unique_lock lck(mtx, std::try_to_lock);
-    if (!newDataReady.load() || !lck) {
+    if (!isDirty(staged.load(std::memory_order_relaxed))) {
       return false;
     }
 
-    std::swap(consumerBuff, this->sharedBuffer);
-    newDataReady = false;
+    // only the consumer clears the dirty bit, so the exchange is guaranteed
+    // to return a fresh frame (possibly newer than the one just observed)
+    const uintptr_t previous = staged.exchange(
+        pack(consumerBuff.release(), false), std::memory_order_acq_rel);
+    consumerBuff.reset(unpack(previous));
     return true;
   }
 
 private:
-  std::mutex mtx;
-  std::atomic<bool> newDataReady;
-  std::unique_ptr<T> sharedBuffer;
+  static_assert(alignof(T) >= 2, "low pointer bit is used as the dirty flag");
+  constexpr static uintptr_t DIRTY_BIT = 1;
+
+  static uintptr_t pack(T *buffer, const bool dirty) {
+    return reinterpret_cast<uintptr_t>(buffer) | (dirty ? DIRTY_BIT : 0);
+  }
+
+  static T *unpack(const uintptr_t word) {
+    return reinterpret_cast<T *>(word & ~DIRTY_BIT);
+  }
+
+  static bool isDirty(const uintptr_t word) { return word & DIRTY_BIT; }
+
+  std::atomic<uintptr_t> staged;
   std::unique_ptr<T> producerWriteBuffer_;
   std::unique_ptr<T> consumerReadBuffer_;
 };
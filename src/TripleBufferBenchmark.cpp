@@ -0,0 +1,91 @@
+#include "TripleBufferBenchmark.h"
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+#include "Clock.h"
+#include "TripleBuffer.h"
+
+namespace {
+// about the size of an AnalysisFrame, so the copy in and out is realistic
+struct Frame {
+  uint64_t sequence{0};
+  std::array<uint64_t, 255> payload{};
+};
+
+void Fill(Frame &frame, const uint64_t sequence) {
+  frame.sequence = sequence;
+  for (size_t i = 0; i < frame.payload.size(); ++i) {
+    frame.payload[i] = sequence * 31 + i;
+  }
+}
+
+bool Intact(const Frame &frame) {
+  for (size_t i = 0; i < frame.payload.size(); ++i) {
+    if (frame.payload[i] != frame.sequence * 31 + i) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+TripleBufferBenchmark::Result
+TripleBufferBenchmark::Run(const Settings &settings) {
+  TripleBuffer<Frame> buffer;
+  std::atomic<bool> producerDone{false};
+  int64_t producerNs = 0;
+
+  const int64_t startNs = NowNanos();
+  std::thread producer([&] {
+    std::unique_ptr<Frame> frame = buffer.producerWriteBuffer();
+    for (uint64_t sequence = 1; sequence <= settings.frames; ++sequence) {
+      Fill(*frame, sequence);
+      const int64_t swapStartNs = NowNanos();
+      buffer.swapProducer(frame);
+      producerNs += NowNanos() - swapStartNs;
+    }
+    producerDone.store(true, std::memory_order_release);
+  });
+
+  Result result;
+  std::unique_ptr<Frame> frame = buffer.consumerReadBuffer();
+  uint64_t lastSequence = 0;
+  int64_t consumerNs = 0;
+  while (true) {
+    // read the flag first: any frame published before it is still staged
+    const bool finished = producerDone.load(std::memory_order_acquire);
+    const int64_t swapStartNs = NowNanos();
+    const bool fresh = buffer.swapConsumer(frame);
+    consumerNs += NowNanos() - swapStartNs;
+
+    if (fresh) {
+      ++result.received;
+      if (!Intact(*frame)) {
+        ++result.torn;
+      }
+      if (frame->sequence <= lastSequence) {
+        ++result.outOfOrder;
+      }
+      lastSequence = frame->sequence;
+    } else {
+      ++result.emptySwaps;
+      if (finished) {
+        break;
+      }
+      // on a single core, let the producer run instead of spinning
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+
+  result.seconds = static_cast<double>(NowNanos() - startNs) * 1e-9;
+  result.producerNsPerSwap =
+      static_cast<double>(producerNs) / static_cast<double>(settings.frames);
+  result.consumerNsPerSwap =
+      static_cast<double>(consumerNs) /
+      static_cast<double>(result.received + result.emptySwaps);
+  result.lastReceived = lastSequence == settings.frames;
+  return result;
+}
@@ -0,0 +1,42 @@
+#ifndef TRIPLE_BUFFER_BENCHMARK_H
+#define TRIPLE_BUFFER_BENCHMARK_H
+
+#include <cstdint>
+
+/*
+        Triple Buffer Stress Test
+
+        A producer publishes numbered frames as fast as it can while a
+   consumer swaps them out just as fast, the most contended case the
+   analyzer and renderer can produce. Every frame is filled with its own
+   number, so the consumer checks each one it receives:
+
+        * torn: a frame whose payload does not match its number, meaning
+   both sides touched the same buffer.
+        * out of order: a frame not newer than the previous one received.
+        * the last frame must arrive after the producer stops; a swap that
+   loses the dirty bit would leave it staged forever.
+*/
+
+class TripleBufferBenchmark {
+public:
+  struct Settings {
+    uint64_t frames{2000000};
+  };
+
+  struct Result {
+    double seconds{0.0};
+    double producerNsPerSwap{0.0};
+    double consumerNsPerSwap{0.0};
+    // frames received; the rest were superseded before the consumer looked
+    uint64_t received{0};
+    uint64_t emptySwaps{0};
+    uint64_t torn{0};
+    uint64_t outOfOrder{0};
+    bool lastReceived{false};
+  };
+
+  static Result Run(const Settings &settings);
+};
+
+#endif
@@ -0,0 +1,331 @@
+#include "WavReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define WAV_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define WAV_NEON 1
+#endif
+
+namespace {
+constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+constexpr float INT16_SCALE = 1.0f / 32768.0f;
+constexpr float INT24_SCALE = 1.0f / 8388608.0f;
+
+template <typename T> T ReadLE(const uint8_t *p) {
+  T value;
+  std::memcpy(&value, p, sizeof(T));
+  return value;
+}
+
+int32_t ReadInt24(const uint8_t *p) {
+  // assemble in the top three bytes, then sign-extend with the shift
+  return static_cast<int32_t>(uint32_t{p[0]} << 8 | uint32_t{p[1]} << 16 |
+                              uint32_t{p[2]} << 24) >>
+         8;
+}
+
+bool ChunkIs(const uint8_t *p, const char *id) {
+  return std::memcmp(p, id, 4) == 0;
+}
+
+float ReadSample(const uint8_t *p, const WavReader::SampleFormat format) {
+  switch (format) {
+  case WavReader::SampleFormat::Int16:
+    return static_cast<float>(ReadLE<int16_t>(p)) * INT16_SCALE;
+  case WavReader::SampleFormat::Int24:
+    return static_cast<float>(ReadInt24(p)) * INT24_SCALE;
+  default:
+    return ReadLE<float>(p);
+  }
+}
+
+// Any layout: average the channels of every frame.
+void ConvertScalar(const uint8_t *src, float *dst, const size_t frames,
+                   const uint32_t channels, const uint32_t blockAlign,
+                   const uint32_t bytesPerSample,
+                   const WavReader::SampleFormat format) {
+  const float channelScale = 1.0f / static_cast<float>(channels);
+  for (size_t i = 0; i < frames; ++i, src += blockAlign) {
+    float sum = 0.0f;
+    for (uint32_t c = 0; c < channels; ++c) {
+      sum += ReadSample(src + c * bytesPerSample, format);
+    }
+    dst[i] = sum * channelScale;
+  }
+}
+
+#if defined(WAV_SSE2)
+// 4 consecutive 24-bit samples from 16 readable bytes. Shifting the register
+// left by k+1 bytes puts sample k in the top three bytes of lane k; the
+// arithmetic shift then sign-extends it and drops the stray low byte.
+__m128i LoadInt24x4(const uint8_t *p) {
+  const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  const __m128i lane0 = _mm_setr_epi32(-1, 0, 0, 0);
+  const __m128i lane1 = _mm_setr_epi32(0, -1, 0, 0);
+  const __m128i lane2 = _mm_setr_epi32(0, 0, -1, 0);
+  const __m128i lane3 = _mm_setr_epi32(0, 0, 0, -1);
+  const __m128i packed = _mm_or_si128(
+      _mm_or_si128(_mm_and_si128(_mm_slli_si128(x, 1), lane0),
+                   _mm_and_si128(_mm_slli_si128(x, 2), lane1)),
+      _mm_or_si128(_mm_and_si128(_mm_slli_si128(x, 3), lane2),
+                   _mm_and_si128(_mm_slli_si128(x, 4), lane3)));
+  return _mm_srai_epi32(packed, 8);
+}
+
+// (L0 R0 L1 R1), (L2 R2 L3 R3) -> (L0+R0 .. L3+R3)
+__m128 SumPairs(const __m128 a, const __m128 b) {
+  return _mm_add_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+                    _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+#elif defined(WAV_NEON)
+#if defined(__aarch64__)
+int32x4_t LoadInt24x4(const uint8_t *p) {
+  // table lookup places each sample in the top three bytes of its lane;
+  // out-of-range indices read as zero
+  static const uint8_t order[16] = {255, 0, 1, 2, 255, 3, 4,  5,
+                                    255, 6, 7, 8, 255, 9, 10, 11};
+  const uint8x16_t x = vqtbl1q_u8(vld1q_u8(p), vld1q_u8(order));
+  return vshrq_n_s32(vreinterpretq_s32_u8(x), 8);
+}
+#endif
+
+float32x4_t SumPairs(const float32x4_t a, const float32x4_t b) {
+  const float32x4x2_t split = vuzpq_f32(a, b);
+  return vaddq_f32(split.val[0], split.val[1]);
+}
+#endif
+
+// Tightly packed mono or stereo; returns how many frames were converted,
+// the caller finishes the tail.
+size_t ConvertInt16(const uint8_t *src, float *dst, const size_t frames,
+                    const uint32_t channels) {
+  const float scale = INT16_SCALE / static_cast<float>(channels);
+  size_t i = 0;
+#if defined(WAV_SSE2)
+  const __m128 vscale = _mm_set1_ps(scale);
+  if (channels == 1) {
+    for (; i + 8 <= frames; i += 8) {
+      const __m128i x =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+      // duplicate each sample into a 32-bit lane, then sign-extend
+      const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+      const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+      _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), vscale));
+      _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vscale));
+    }
+  } else {
+    // pmaddwd with ones adds each L/R pair into a 32-bit lane
+    const __m128i ones = _mm_set1_epi16(1);
+    for (; i + 4 <= frames; i += 4) {
+      const __m128i x =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+      const __m128i sums = _mm_madd_epi16(x, ones);
+      _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(sums), vscale));
+    }
+  }
+#elif defined(WAV_NEON)
+  if (channels == 1) {
+    for (; i + 8 <= frames; i += 8) {
+      const int16x8_t x = vreinterpretq_s16_u8(vld1q_u8(src + i * 2));
+      const int32x4_t lo = vmovl_s16(vget_low_s16(x));
+      const int32x4_t hi = vmovl_s16(vget_high_s16(x));
+      vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(lo), scale));
+      vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(hi), scale));
+    }
+  } else {
+    for (; i + 4 <= frames; i += 4) {
+      const int16x8_t x = vreinterpretq_s16_u8(vld1q_u8(src + i * 4));
+      // pairwise widening add sums each L/R pair
+      vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vpaddlq_s16(x)), scale));
+    }
+  }
+#else
+  (void)src;
+  (void)dst;
+  (void)frames;
+  (void)scale;
+#endif
+  return i;
+}
+
+// As ConvertInt16; srcBytes bounds the 16-byte loads that cover 12 bytes.
+size_t ConvertInt24(const uint8_t *src, float *dst, const size_t frames,
+                    const uint32_t channels, const size_t srcBytes) {
+  const float scale = INT24_SCALE / static_cast<float>(channels);
+  const size_t frameBytes = 3 * channels;
+  size_t i = 0;
+#if defined(WAV_SSE2)
+  const __m128 vscale = _mm_set1_ps(scale);
+  if (channels == 1) {
+    for (; i + 4 <= frames && i * 3 + 16 <= srcBytes; i += 4) {
+      const __m128 x = _mm_cvtepi32_ps(LoadInt24x4(src + i * 3));
+      _mm_storeu_ps(dst + i, _mm_mul_ps(x, vscale));
+    }
+  } else {
+    for (; i + 4 <= frames && i * frameBytes + 28 <= srcBytes; i += 4) {
+      const uint8_t *p = src + i * frameBytes;
+      const __m128 a = _mm_cvtepi32_ps(LoadInt24x4(p));
+      const __m128 b = _mm_cvtepi32_ps(LoadInt24x4(p + 12));
+      _mm_storeu_ps(dst + i, _mm_mul_ps(SumPairs(a, b), vscale));
+    }
+  }
+#elif defined(WAV_NEON) && defined(__aarch64__)
+  if (channels == 1) {
+    for (; i + 4 <= frames && i * 3 + 16 <= srcBytes; i += 4) {
+      const float32x4_t x = vcvtq_f32_s32(LoadInt24x4(src + i * 3));
+      vst1q_f32(dst + i, vmulq_n_f32(x, scale));
+    }
+  } else {
+    for (; i + 4 <= frames && i * frameBytes + 28 <= srcBytes; i += 4) {
+      const uint8_t *p = src + i * frameBytes;
+      const float32x4_t a = vcvtq_f32_s32(LoadInt24x4(p));
+      const float32x4_t b = vcvtq_f32_s32(LoadInt24x4(p + 12));
+      vst1q_f32(dst + i, vmulq_n_f32(SumPairs(a, b), scale));
+    }
+  }
+#else
+  (void)src;
+  (void)dst;
+  (void)frames;
+  (void)scale;
+  (void)frameBytes;
+  (void)srcBytes;
+#endif
+  return i;
+}
+
+size_t ConvertFloat32(const uint8_t *src, float *dst, const size_t frames,
+                      const uint32_t channels) {
+  if (channels == 1) {
+    std::memcpy(dst, src, frames * sizeof(float));
+    return frames;
+  }
+  size_t i = 0;
+#if defined(WAV_SSE2)
+  const __m128 half = _mm_set1_ps(0.5f);
+  for (; i + 4 <= frames; i += 4) {
+    const auto *p = reinterpret_cast<const float *>(src + i * 8);
+    const __m128 sums = SumPairs(_mm_loadu_ps(p), _mm_loadu_ps(p + 4));
+    _mm_storeu_ps(dst + i, _mm_mul_ps(sums, half));
+  }
+#elif defined(WAV_NEON)
+  for (; i + 4 <= frames; i += 4) {
+    const auto *p = reinterpret_cast<const float *>(src + i * 8);
+    const float32x4_t sums = SumPairs(vld1q_f32(p), vld1q_f32(p + 4));
+    vst1q_f32(dst + i, vmulq_n_f32(sums, 0.5f));
+  }
+#else
+  (void)src;
+  (void)dst;
+#endif
+  return i;
+}
+} // namespace
+
+bool WavReader::Open(const uint8_t *image, const size_t size) {
+  this->format_ = SampleFormat::Unsupported;
+  if (size < 12 || !ChunkIs(image, "RIFF") || !ChunkIs(image + 8, "WAVE")) {
+    return false;
+  }
+
+  uint16_t formatTag = 0;
+  uint16_t bitsPerSample = 0;
+  bool haveFormat = false;
+
+  size_t offset = 12;
+  while (offset + 8 <= size) {
+    const uint8_t *chunk = image + offset;
+    const size_t chunkSize = ReadLE<uint32_t>(chunk + 4);
+    const uint8_t *body = chunk + 8;
+    const size_t bodySize = std::min(chunkSize, size - offset - 8);
+
+    if (ChunkIs(chunk, "fmt ") && bodySize >= 16) {
+      formatTag = ReadLE<uint16_t>(body);
+      this->channels_ = ReadLE<uint16_t>(body + 2);
+      this->sampleRate_ = ReadLE<uint32_t>(body + 4);
+      this->blockAlign_ = ReadLE<uint16_t>(body + 12);
+      bitsPerSample = ReadLE<uint16_t>(body + 14);
+      if (formatTag == WAVE_FORMAT_EXTENSIBLE && bodySize >= 26) {
+        // first two bytes of the sub-format GUID carry the real tag
+        formatTag = ReadLE<uint16_t>(body + 24);
+      }
+      haveFormat = true;
+    } else if (ChunkIs(chunk, "data") && haveFormat) {
+      if (formatTag == WAVE_FORMAT_PCM && bitsPerSample == 16) {
+        this->format_ = SampleFormat::Int16;
+      } else if (formatTag == WAVE_FORMAT_PCM && bitsPerSample == 24) {
+        this->format_ = SampleFormat::Int24;
+      } else if (formatTag == WAVE_FORMAT_IEEE_FLOAT && bitsPerSample == 32) {
+        this->format_ = SampleFormat::Float32;
+      }
+
+      const uint32_t minAlign = this->channels_ * (bitsPerSample / 8);
+      if (this->channels_ == 0 || this->blockAlign_ < minAlign ||
+          this->sampleRate_ == 0) {
+        this->format_ = SampleFormat::Unsupported;
+      }
+      if (this->format_ == SampleFormat::Unsupported) {
+        return false;
+      }
+
+      this->bytesPerSample_ = bitsPerSample / 8;
+      this->samples_ = body;
+      this->frameCount_ = bodySize / this->blockAlign_;
+      this->cursor_ = 0;
+      return true;
+    }
+
+    // chunks are padded to an even size
+    offset += 8 + chunkSize + (chunkSize & 1);
+  }
+  return false;
+}
+
+size_t WavReader::ReadFrames(float *out, const size_t frames) {
+  const auto count =
+      static_cast<size_t>(std::min<uint64_t>(frames, frameCount_ - cursor_));
+  const uint8_t *src = samples_ + cursor_ * blockAlign_;
+
+  size_t done = 0;
+  const bool packed =
+      (channels_ == 1 || channels_ == 2) &&
+      blockAlign_ == channels_ * bytesPerSample_;
+  if (useSimd_ && packed) {
+    switch (format_) {
+    case SampleFormat::Int16:
+      done = ConvertInt16(src, out, count, channels_);
+      break;
+    case SampleFormat::Int24:
+      done = ConvertInt24(src, out, count, channels_,
+                          static_cast<size_t>(frameCount_ - cursor_) *
+                              blockAlign_);
+      break;
+    case SampleFormat::Float32:
+      done = ConvertFloat32(src, out, count, channels_);
+      break;
+    default:
+      break;
+    }
+  }
+  ConvertScalar(src + done * blockAlign_, out + done, count - done, channels_,
+                blockAlign_, bytesPerSample_, format_);
+
+  cursor_ += count;
+  return count;
+}
+
+bool WavReader::SeekToFrame(const uint64_t frame) {
+  if (frame > frameCount_) {
+    return false;
+  }
+  cursor_ = frame;
+  return true;
+}
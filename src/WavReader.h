@@ -0,0 +1,51 @@
+#ifndef WAV_READER_H
+#define WAV_READER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+        Direct WAV Reader
+
+        Parses a RIFF/WAVE header once and reads uncompressed PCM straight
+   out of an in-memory (mapped) image, converting to the mono float stream
+   the rest of the pipeline expects. Used instead of ma_decoder for the
+   formats it supports; anything else goes through the decoder.
+
+        * 16-bit, 24-bit and float samples are supported.
+        * Tightly packed mono and stereo, by far the common layouts, convert
+   and downmix with SSE2 or NEON; other layouts take a scalar loop.
+*/
+
+class WavReader {
+public:
+  enum class SampleFormat { Unsupported, Int16, Int24, Float32 };
+
+  // Returns false if the image is not a WAV the fast path can handle.
+  bool Open(const uint8_t *image, size_t size);
+
+  size_t ReadFrames(float *out, size_t frames);
+  bool SeekToFrame(uint64_t frame);
+
+  // Force the scalar conversion, e.g. to benchmark against it
+  void SetSimd(bool enabled) { useSimd_ = enabled; }
+
+  [[nodiscard]] uint32_t sampleRate() const { return sampleRate_; }
+  [[nodiscard]] uint32_t channels() const { return channels_; }
+  [[nodiscard]] uint64_t frameCount() const { return frameCount_; }
+  [[nodiscard]] uint64_t cursor() const { return cursor_; }
+  [[nodiscard]] SampleFormat format() const { return format_; }
+
+private:
+  const uint8_t *samples_{nullptr};
+  uint64_t frameCount_{0};
+  uint64_t cursor_{0};
+  uint32_t sampleRate_{0};
+  uint32_t channels_{0};
+  uint32_t blockAlign_{0};
+  uint32_t bytesPerSample_{0};
+  SampleFormat format_{SampleFormat::Unsupported};
+  bool useSimd_{true};
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(const size_t workerCount)
+    : workerCount(workerCount != 0
+                      ? workerCount
+                      : std::max<size_t>(1, std::thread::hardware_concurrency())),
+      deques(std::make_unique<Deque[]>(this->workerCount)),
+      stats(this->workerCount) {}
+
+void WorkStealingPool::Run(const size_t taskCount, const Task &task) {
+  for (size_t w = 0; w < this->workerCount; ++w) {
+    Deque &deque = this->deques[w];
+    deque.tasks.clear();
+    for (size_t i = w; i < taskCount; i += this->workerCount) {
+      deque.tasks.push_back(i);
+    }
+    deque.top.store(0, std::memory_order_relaxed);
+    deque.bottom.store(static_cast<int64_t>(deque.tasks.size()),
+                       std::memory_order_relaxed);
+    this->stats[w] = WorkerStats{};
+  }
+
+  // thread creation publishes the deques to the workers
+  std::vector<std::thread> workers;
+  workers.reserve(this->workerCount - 1);
+  for (size_t w = 1; w < this->workerCount; ++w) {
+    workers.emplace_back(&WorkStealingPool::Work, this, w, std::cref(task));
+  }
+  this->Work(0, task);
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+}
+
+void WorkStealingPool::SetTuning(const ThreadTuning::Settings &settings) {
+  this->tuning = settings;
+}
+
+void WorkStealingPool::Work(const size_t worker, const Task &task) {
+  if (worker != 0) {
+    ThreadTuning::Apply("worker " + std::to_string(worker), this->tuning);
+  }
+  Deque &own = this->deques[worker];
+  WorkerStats &stats = this->stats[worker];
+  size_t next;
+
+  while (true) {
+    if (own.Pop(next)) {
+      task(next, worker);
+      ++stats.executed;
+      continue;
+    }
+
+    // own deque is drained; sweep the others starting with the neighbour
+    bool stole = false;
+    for (size_t i = 1; i < this->workerCount && !stole; ++i) {
+      stole = this->deques[(worker + i) % this->workerCount].Steal(next);
+    }
+    if (!stole) {
+      return;
+    }
+    task(next, worker);
+    ++stats.executed;
+    ++stats.stolen;
+  }
+}
+
+// Owner only. Takes the newest task; races thieves only for the last one.
+bool WorkStealingPool::Deque::Pop(size_t &task) {
+  const int64_t b = this->bottom.load(std::memory_order_relaxed) - 1;
+  this->bottom.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t t = this->top.load(std::memory_order_relaxed);
+
+  if (t > b) {
+    this->bottom.store(b + 1, std::memory_order_relaxed);
+    return false;
+  }
+
+  task = this->tasks[static_cast<size_t>(b)];
+  if (t == b) {
+    const bool won = this->top.compare_exchange_strong(
+        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    this->bottom.store(b + 1, std::memory_order_relaxed);
+    return won;
+  }
+  return true;
+}
+
+// Any thread. Takes the oldest task, retrying while the deque is non-empty.
+bool WorkStealingPool::Deque::Steal(size_t &task) {
+  while (true) {
+    int64_t t = this->top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = this->bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+      return false;
+    }
+
+    task = this->tasks[static_cast<size_t>(t)];
+    if (this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
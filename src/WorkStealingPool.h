@@ -0,0 +1,79 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <__new/interference_size.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "ThreadTuning.h"
+
+/*
+        Work-Stealing Pool
+
+        Runs a fixed set of independent tasks (e.g. one per file) on one
+   worker per core. Task costs vary a lot (a 10 s clip next to a 2 h mix), so
+   a static split would leave cores idle at the end of a batch.
+
+        * Tasks are dealt round-robin into one Chase-Lev deque per worker
+   before the workers start.
+        * A worker pops from the bottom of its own deque (no contention in
+   the common case) and, once it is empty, steals from the top of the
+   others'.
+        * Nothing is pushed while running, so the deque array never grows and
+   a worker may exit after a full sweep finds every deque empty.
+*/
+
+class WorkStealingPool {
+public:
+  using Task = std::function<void(size_t task, size_t worker)>;
+
+  struct WorkerStats {
+    uint64_t executed{0};
+    uint64_t stolen{0};
+  };
+
+  // workerCount 0 uses one worker per hardware thread
+  explicit WorkStealingPool(size_t workerCount = 0);
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool(WorkStealingPool &&) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(WorkStealingPool &&) = delete;
+  ~WorkStealingPool() = default;
+
+  // Runs task(i, worker) for every i in [0, taskCount) and returns once all
+  // of them finished.
+  void Run(size_t taskCount, const Task &task);
+
+  // Applied to the spawned workers as they start; worker 0 is the calling
+  // thread and is left as it is.
+  void SetTuning(const ThreadTuning::Settings &settings);
+
+  [[nodiscard]] size_t WorkerCount() const { return this->workerCount; }
+  [[nodiscard]] const std::vector<WorkerStats> &GetStats() const {
+    return this->stats;
+  }
+
+private:
+  struct alignas(std::hardware_destructive_interference_size) Deque {
+    std::atomic<int64_t> top{0};
+    alignas(std::hardware_destructive_interference_size)
+        std::atomic<int64_t> bottom{0};
+    std::vector<size_t> tasks;
+
+    bool Pop(size_t &task);
+    bool Steal(size_t &task);
+  };
+
+  void Work(size_t worker, const Task &task);
+
+  size_t workerCount;
+  ThreadTuning::Settings tuning;
+  std::unique_ptr<Deque[]> deques;
+  std::vector<WorkerStats> stats;
+};
+
+#endif
@@ -1,10 +1,28 @@
 #include "AnalyzerThread.h"
 #include "AudioEngine.h"
+#include "BatchAnalyzer.h"
+#include "Clock.h"
+#include "BarBenchmark.h"
+#include "BroadcastBenchmark.h"
+#include "BucketBenchmark.h"
+#include "ConversionBenchmark.h"
+#include "DenormalBenchmark.h"
+#include "DrainBenchmark.h"
+#include "IoBenchmark.h"
 #include "GraphicsThread.h"
-#include "RingBuffer.h"
+#include "Options.h"
+#include "Recorder.h"
+#include "SnapshotBenchmark.h"
+#include "SpectralCache.h"
+#include "TrackAnalyzer.h"
 #include "TripleBuffer.h"
+#include "TripleBufferBenchmark.h"
 #include "constants.h"
 
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
 #pragma comment(lib, "user32.lib")
 #pragma comment(lib, "gdi32.lib")
 #pragma comment(lib, "winmm.lib")
@@ -15,32 +33,577 @@
 
 
 std::atomic_bool doneFlag(false);
-int main() {
-  // select to play any file in demos directory
-  std::string filePath = "demos/audio3.wav";
-  constexpr size_t binCount = FFT_SIZE / 2;
-  TripleBuffer<std::vector<float>> tripleBuffer(binCount);
 
-  // SPSC lock-free ring buffer used by audio callback and analyzer
+static void PrintReaderStats(const char *name,
+                             const BroadcastRing::ConsumerStats &stats) {
+  std::cout << "Broadcast " << name << ": read=" << stats.samplesRead
+            << " skipped=" << stats.samplesSkipped
+            << " flushed=" << stats.samplesFlushed
+            << " laps=" << stats.lapCount << " maxLag=" << stats.maxLag << "/"
+            << BroadcastRing::BUFFER_SIZE << '\n';
+}
+
+static void PrintTelemetry(const BroadcastRing &ring,
+                           const AnalyzerThread &analyzer,
+                           const Recorder *recorder, const AudioEngine &engine,
+                           const GraphicsThread &visualizer) {
+  const Histogram::Snapshot frames =
+      engine.GetFrameCountHistogram().GetSnapshot();
+  const Histogram::Snapshot callbackNs =
+      engine.GetCallbackDurationHistogram().GetSnapshot();
+  const Histogram::Snapshot jitterNs =
+      engine.GetCallbackJitterHistogram().GetSnapshot();
+
+  std::cout << "Broadcast: pushed=" << ring.GetSamplesPushed() << '\n';
+  if (analyzer.IsLaunched()) {
+    PrintReaderStats("analyzer", analyzer.GetInputStats());
+  }
+  if (recorder != nullptr) {
+    const Recorder::Stats stats = recorder->GetStats();
+    std::cout << "Recorder: written=" << stats.framesWritten
+              << " lost=" << stats.framesLost << " laps=" << stats.laps
+              << '\n';
+  }
+  std::cout << "AudioEngine: callbacks=" << frames.count
+            << " frames/callback p50=" << frames.Percentile(50.0)
+            << " p99=" << frames.Percentile(99.0) << " max=" << frames.max
+            << '\n';
+  std::cout << "AudioEngine: underrunFrames=" << engine.GetUnderrunFrames()
+            << " callback ns p50=" << callbackNs.Percentile(50.0)
+            << " p99=" << callbackNs.Percentile(99.0)
+            << " max=" << callbackNs.max << '\n';
+  const DeadlineMonitor::Summary deadline =
+      engine.GetDeadlineMonitor().GetSummary();
+  const Histogram::Snapshot load =
+      engine.GetDeadlineMonitor().GetLoadHistogram().GetSnapshot();
+  std::cout << "AudioEngine: callback load %period p50="
+            << load.Percentile(50.0) / 10.0
+            << " p99=" << load.Percentile(99.0) / 10.0
+            << " max=" << load.max / 10.0 << " overBudget("
+            << deadline.budgetPermille / 10 << "%)=" << deadline.overBudget
+            << '/' << deadline.callbacks << '\n';
+  std::cout << "AudioEngine: callback jitter us p50="
+            << jitterNs.Percentile(50.0) / 1000
+            << " p99=" << jitterNs.Percentile(99.0) / 1000
+            << " max=" << jitterNs.max / 1000 << '\n';
+
+  const Histogram::Snapshot staleness =
+      visualizer.GetStalenessHistogram().GetSnapshot();
+  std::cout << "Capture->draw latency (us): frames=" << staleness.count
+            << " p50=" << staleness.Percentile(50.0)
+            << " p99=" << staleness.Percentile(99.0)
+            << " max=" << staleness.max << std::endl;
+}
+
+static AudioEngine::Settings EngineSettings(const AppOptions &options) {
+  AudioEngine::Settings settings;
+  settings.memoryMapping = options.memoryMapping;
+  settings.nullBackend = options.nullBackend;
+  settings.tracks = options.playlist;
+  settings.avOffsetMs = options.avOffsetMs;
+  settings.periodSizeInFrames = options.periodSizeInFrames;
+  settings.periodCount = options.periodCount;
+  settings.callbackBudget = options.callbackBudgetPercent / 100.0;
+  settings.readAheadTuning = options.readAheadTuning;
+  if (options.lowLatency) {
+    // ~2.7 ms periods at 48 kHz; explicit --period/--periods still win
+    constexpr uint32_t lowLatencyPeriod = 128;
+    constexpr uint32_t lowLatencyPeriods = 2;
+    if (settings.periodSizeInFrames == 0) {
+      settings.periodSizeInFrames = lowLatencyPeriod;
+    }
+    if (settings.periodCount == 0) {
+      settings.periodCount = lowLatencyPeriods;
+    }
+  }
+  if (options.conservative) {
+    settings.performanceProfile = ma_performance_profile_conservative;
+  }
+  if (options.capture) {
+    settings.inputMode = AudioEngine::InputMode::Capture;
+  } else if (options.loopback) {
+    settings.inputMode = AudioEngine::InputMode::Loopback;
+  }
+  return settings;
+}
+
+// Transport keys for file playback; loopStart holds the pending '[' mark
+static void HandleTransportKeys(AudioEngine &engine, int64_t &loopStart) {
+  constexpr int64_t seekSeconds = 5;
+  const int64_t rate = engine.GetSampleRate();
+  const int64_t position = engine.GetAudibleSourceFrame();
+
+  if (IsKeyPressed(KEY_SPACE)) {
+    engine.TogglePause();
+  }
+  if (IsKeyPressed(KEY_RIGHT)) {
+    engine.Seek(static_cast<uint64_t>(position + seekSeconds * rate));
+  }
+  if (IsKeyPressed(KEY_LEFT)) {
+    engine.Seek(static_cast<uint64_t>(
+        std::max<int64_t>(0, position - seekSeconds * rate)));
+  }
+  if (IsKeyPressed(KEY_HOME)) {
+    engine.Seek(0);
+  }
+  if (IsKeyPressed(KEY_LEFT_BRACKET)) {
+    loopStart = position;
+  }
+  if (IsKeyPressed(KEY_RIGHT_BRACKET) && loopStart >= 0 &&
+      position > loopStart) {
+    engine.SetLoopRegion(static_cast<uint64_t>(loopStart),
+                         static_cast<uint64_t>(position));
+    // start the loop from the top rather than waiting for its end
+    engine.Seek(static_cast<uint64_t>(loopStart));
+  }
+  if (IsKeyPressed(KEY_BACKSPACE)) {
+    engine.ClearLoopRegion();
+    loopStart = -1;
+  }
+}
+
+static int RunOffline(const AppOptions &options) {
+  std::string filePath = options.filePath;
+  TripleBuffer<AnalysisFrame> tripleBuffer;
+  BroadcastRing output;
+  AudioEngine audioObj(output, filePath);
+  audioObj.Configure(EngineSettings(options));
+
+  if (!audioObj.InitOffline()) {
+    return EXIT_FAILURE;
+  }
+
+  int64_t busyNs = 0;
+  uint64_t hops = 0;
+  AudioEngine::OfflineReport report;
+  uint32_t analysisRate = 0;
+  {
+    AnalyzerThread analyzerThread(output, tripleBuffer, doneFlag);
+    analyzerThread.Configure(audioObj.GetSampleRate(), options.analysisRate);
+    analyzerThread.SetTuning(options.analyzerTuning);
+    analysisRate = analyzerThread.GetAnalysisRate();
+    analyzerThread.Launch();
+    if (!analyzerThread.IsLaunched()) {
+      return EXIT_FAILURE;
+    }
+    report = audioObj.RunOffline(options.offlineRealtime, doneFlag);
+
+    // let the analyzer finish every complete hop before stopping it
+    analyzerThread.Drain();
+    doneFlag.store(true);
+    busyNs = analyzerThread.GetBusyNanos();
+    hops = analyzerThread.GetHopCount();
+  }
+
+  const double analyzedSeconds =
+      static_cast<double>(hops * HOP_SIZE) / analysisRate;
+  const double busySeconds = static_cast<double>(busyNs) * 1e-9;
+
+  std::cout << "Offline: " << report.audioSeconds << " s of audio at "
+            << report.sampleRate << " Hz in " << report.wallSeconds
+            << " s wall\n";
+  std::cout << "  decode:   " << report.decodeSeconds << " s ("
+            << report.audioSeconds / std::max(report.decodeSeconds, 1e-9)
+            << "x realtime)\n";
+  std::cout << "  analysis: " << hops << " hops at " << analysisRate
+            << " Hz, " << busySeconds << " s ("
+            << analyzedSeconds / std::max(busySeconds, 1e-9) << "x realtime)"
+            << std::endl;
+  return EXIT_SUCCESS;
+}
+
+static int RunPrecompute(const AppOptions &options) {
+  const std::vector<std::string> inputs =
+      options.playlist.empty() ? std::vector<std::string>{options.filePath}
+                               : options.playlist;
+
+  TrackAnalyzer::Settings settings;
+  settings.analysisRate = options.analysisRate;
+  settings.memoryMapping = options.memoryMapping;
+
+  TrackAnalyzer analyzer;
+  int failures = 0;
+  for (const std::string &input : inputs) {
+    const std::string cachePath = SpectralCache::PathFor(input);
+    const int64_t startNs = NowNanos();
+    const TrackAnalyzer::Result result = SpectralCache::Build(
+        analyzer, input, cachePath, settings, options.cacheBits);
+    if (!result.ok) {
+      std::cerr << "Failed to precompute " << input << '\n';
+      ++failures;
+      continue;
+    }
+
+    const double seconds = static_cast<double>(NowNanos() - startNs) * 1e-9;
+    const double audioSeconds =
+        static_cast<double>(result.sourceFrames) / result.sourceRate;
+    std::cout << cachePath << ": " << result.hops << " frames, "
+              << audioSeconds << " s of audio in " << seconds << " s ("
+              << audioSeconds / seconds << "x realtime)\n";
+  }
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int RunBatch(const AppOptions &options) {
+  const std::vector<BatchAnalyzer::Input> inputs = BatchAnalyzer::CollectInputs(
+      options.playlist.empty() ? std::vector<std::string>{options.filePath}
+                               : options.playlist);
+
+  BatchAnalyzer::Settings settings;
+  settings.analysis.analysisRate = options.analysisRate;
+  settings.analysis.memoryMapping = options.memoryMapping;
+  settings.outputDir = options.batchOutputDir;
+  settings.workers = options.jobs;
+  settings.workerTuning = options.workerTuning;
+
+  BatchAnalyzer batch;
+  const BatchAnalyzer::Report report = batch.Run(inputs, settings);
+  if (report.collisions > 0) {
+    std::cerr << "Batch: " << report.collisions
+              << " output path(s) claimed twice, nothing analyzed\n";
+    return EXIT_FAILURE;
+  }
+
+  for (const BatchAnalyzer::FileResult &result : batch.GetResults()) {
+    if (!result.analysis.ok) {
+      continue;
+    }
+    const double audioSeconds =
+        static_cast<double>(result.analysis.sourceFrames) /
+        result.analysis.sourceRate;
+    std::cout << result.output << ": " << audioSeconds << " s audio, "
+              << result.analysis.hops << " hops, "
+              << static_cast<double>(result.wallNs) * 1e-6
+              << " ms (decode "
+              << static_cast<double>(result.analysis.decodeNs) * 1e-6
+              << " ms, analysis "
+              << static_cast<double>(result.analysis.analysisNs) * 1e-6
+              << " ms) on worker " << result.worker << '\n';
+  }
+
+  std::cout << "Batch: " << report.files - report.failed << "/"
+            << report.files << " files, " << report.audioSeconds
+            << " s of audio in " << report.wallSeconds << " s wall on "
+            << report.workers << " workers ("
+            << report.audioSeconds / report.wallSeconds << "x realtime, "
+            << static_cast<double>(report.files) / report.wallSeconds
+            << " files/s, " << report.stolen << " stolen, "
+            << 100.0 * report.busySeconds /
+                   (report.wallSeconds * static_cast<double>(report.workers))
+            << "% utilization)" << std::endl;
+  return report.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
-  RingBuffer sharedRingBuffer;
+static int RunDenormalBenchmark() {
+  const DenormalBenchmark::Settings settings;
+  const std::vector<DenormalBenchmark::Band> plain =
+      DenormalBenchmark::Run(settings, false);
+  const std::vector<DenormalBenchmark::Band> flushed =
+      DenormalBenchmark::Run(settings, true);
 
-  AudioEngine audioObj(sharedRingBuffer, filePath);
+  std::cout << "Denormal benchmark: " << settings.frequency
+            << " Hz sine decaying to " << settings.finalAmplitude << " over "
+            << settings.seconds << " s, " << settings.sampleRate << " -> "
+            << settings.analysisRate << " Hz\n";
+  std::cout << "  from s   amplitude   hop us default (max)   hop us FTZ/DAZ "
+               "(max)\n";
+  for (size_t i = 0; i < plain.size() && i < flushed.size(); ++i) {
+    std::cout << "  " << plain[i].startSeconds << "\t" << plain[i].amplitude
+              << "\t" << plain[i].meanHopNs / 1000.0 << " ("
+              << plain[i].maxHopNs / 1000.0 << ")\t"
+              << flushed[i].meanHopNs / 1000.0 << " ("
+              << flushed[i].maxHopNs / 1000.0 << ")\n";
+  }
+  std::cout << std::flush;
+  return EXIT_SUCCESS;
+}
+
+static int RunConversionBenchmark() {
+  const ConversionBenchmark::Settings settings;
+  std::cout << "WAV conversion to mono float, " << settings.frames
+            << " frames in chunks of " << settings.chunkFrames << '\n';
+  std::cout << "  format  ch  SIMD Msamples/s  scalar Msamples/s  speedup  "
+               "max diff\n";
+  for (const ConversionBenchmark::Result &result :
+       ConversionBenchmark::Run(settings)) {
+    std::cout << "  " << ConversionBenchmark::FormatName(result.format) << '\t'
+              << result.channels << '\t' << result.simdSamplesPerSecond * 1e-6
+              << '\t' << result.scalarSamplesPerSecond * 1e-6 << '\t'
+              << result.simdSamplesPerSecond /
+                     std::max(result.scalarSamplesPerSecond, 1.0)
+              << "x\t" << result.maxDifference << '\n';
+  }
+  std::cout << std::flush;
+  return EXIT_SUCCESS;
+}
+
+static int RunBarBenchmark() {
+  const BarBenchmark::Settings settings;
+  const BarBenchmark::Result result = BarBenchmark::Run(settings);
+  std::cout << "Bar submission, " << settings.screenWidth << "x"
+            << settings.screenHeight << ", " << settings.frames
+            << " frames, draw calls counted instead of issued\n"
+            << "  instance arrays:   " << result.instancesNsPerFrame
+            << " ns/frame (" << result.instanceCalls / settings.frames
+            << " calls)\n"
+            << "  Drawable objects:  " << result.drawablesNsPerFrame
+            << " ns/frame (" << result.drawableCalls / settings.frames
+            << " calls, "
+            << result.drawablesNsPerFrame /
+                   std::max(result.instancesNsPerFrame, 1e-9)
+            << "x)\n"
+            << "  same rectangles: " << (result.sameRectangles ? "yes" : "NO")
+            << std::endl;
+  return result.instanceCalls == result.drawableCalls &&
+                 result.sameRectangles
+             ? EXIT_SUCCESS
+             : EXIT_FAILURE;
+}
+
+static int RunBucketBenchmark() {
+  const BucketBenchmark::Settings settings;
+  const BucketBenchmark::Result result = BucketBenchmark::Run(settings);
+  std::cout << "Spectrum to " << Constants::BUCKET_COUNT << " bars, " << settings.frames
+            << " frames\n"
+            << "  table + prefix sums: " << result.tableNsPerFrame
+            << " ns/frame\n"
+            << "  powf per bar:        " << result.referenceNsPerFrame
+            << " ns/frame ("
+            << result.referenceNsPerFrame /
+                   std::max(result.tableNsPerFrame, 1e-9)
+            << "x)\n"
+            << "  ranges differing: " << result.mismatchedRanges
+            << ", max bar difference " << result.maxDifference << std::endl;
+  return result.mismatchedRanges == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int RunBroadcastBenchmark() {
+  const BroadcastBenchmark::Settings settings;
+  const BroadcastBenchmark::Result result = BroadcastBenchmark::Run(settings);
+  std::cout << "Broadcast ring, " << settings.samples << " samples in "
+            << settings.blockSize << "-sample blocks at " << settings.speed
+            << "x real time: " << result.seconds << " s, push "
+            << result.pushNsPerSample << " ns/sample\n";
+  uint64_t errors = 0;
+  for (const BroadcastBenchmark::ReaderResult &reader : result.readers) {
+    std::cout << "  " << reader.label << ": read=" << reader.stats.samplesRead
+              << " skipped=" << reader.stats.samplesSkipped
+              << " laps=" << reader.stats.lapCount
+              << " maxLag=" << reader.stats.maxLag
+              << " errors=" << reader.errors << '\n';
+    errors += reader.errors;
+  }
+  std::cout << std::flush;
+  return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int RunTripleBufferBenchmark() {
+  const TripleBufferBenchmark::Settings settings;
+  const TripleBufferBenchmark::Result result =
+      TripleBufferBenchmark::Run(settings);
+  const bool ok =
+      result.torn == 0 && result.outOfOrder == 0 && result.lastReceived;
+  std::cout << "Triple buffer, " << settings.frames << " frames in "
+            << result.seconds << " s\n"
+            << "  swap ns: producer " << result.producerNsPerSwap
+            << ", consumer " << result.consumerNsPerSwap << '\n'
+            << "  received " << result.received << " (rest superseded), "
+            << result.emptySwaps << " empty swaps\n"
+            << "  torn " << result.torn << ", out of order "
+            << result.outOfOrder << ", last frame "
+            << (result.lastReceived ? "received" : "MISSED") << std::endl;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int RunSnapshotBenchmark() {
+  const SnapshotBenchmark::Settings settings;
+  std::cout << "Snapshot channel, " << sizeof(AnalysisFrame)
+            << "-byte frames, " << settings.publishes << " publishes\n";
+  uint64_t torn = 0;
+  for (const SnapshotBenchmark::Row &row : SnapshotBenchmark::Run(settings)) {
+    std::cout << "  " << row.readers << " readers: publish " << row.publishNs
+              << " ns, read " << row.readNs << " ns (" << row.reads
+              << " reads), torn " << row.torn << '\n';
+    torn += row.torn;
+  }
+  std::cout << std::flush;
+  return torn == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int RunDrainBenchmark() {
+  const DrainBenchmark::Settings settings;
+  std::cout << "Offline drain, analysis at " << settings.analysisRate
+            << " Hz\n";
+  bool ok = true;
+  for (const DrainBenchmark::Case &result : DrainBenchmark::Run(settings)) {
+    const bool passed = result.drained && result.hops == result.expectedHops;
+    std::cout << "  " << result.inputRate << " Hz, " << result.frames
+              << " frames: " << result.hops << "/" << result.expectedHops
+              << " hops, " << (result.drained ? "drained" : "TIMED OUT")
+              << " in " << result.drainMs << " ms"
+              << (passed ? "" : "  FAIL") << '\n';
+    ok = ok && passed;
+  }
+  std::cout << std::flush;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int RunIoBenchmark(const AppOptions &options) {
+  const std::vector<std::string> inputs =
+      options.playlist.empty() ? std::vector<std::string>{options.filePath}
+                               : options.playlist;
+  const IoBenchmark::Settings settings;
+
+  std::cout << "Decoder I/O, " << PrefetchReader::CHUNK_SIZE / 1024
+            << " KiB chunks x " << PrefetchReader::SLOT_COUNT << " ahead\n";
+  int failures = 0;
+  for (const std::string &input : inputs) {
+    std::cout << input << '\n';
+    const struct {
+      const char *label;
+      bool cold;
+      IoBenchmark::Access access;
+    } runs[] = {{"cold", true, IoBenchmark::Access::Default},
+                {"warm", false, IoBenchmark::Access::Default},
+                {"cold", true, IoBenchmark::Access::NoMapping},
+                {"cold", true, IoBenchmark::Access::Stdio}};
+    for (const auto &run : runs) {
+      const IoBenchmark::Result result =
+          IoBenchmark::Run(input, settings, run.cold, run.access);
+      if (!result.ok) {
+        std::cerr << "  could not open " << input << '\n';
+        ++failures;
+        break;
+      }
+      std::cout << "  " << run.label << '\t'
+                << TrackSource::PathName(result.path);
+      if (result.backend != PrefetchReader::Backend::None) {
+        std::cout << " [" << PrefetchReader::BackendName(result.backend)
+                  << "]";
+      }
+      std::cout << ": " << result.frames << " frames in "
+                << static_cast<double>(result.decodeNs) * 1e-6 << " ms";
+      if (result.path == TrackSource::Path::PrefetchDecoder) {
+        std::cout << ", " << result.io.chunksFetched << " chunks, "
+                  << result.io.stalls << "/" << result.io.reads
+                  << " reads stalled, "
+                  << static_cast<double>(result.io.stallNs) * 1e-6
+                  << " ms waiting (max "
+                  << static_cast<double>(result.io.maxStallNs) * 1e-6
+                  << " ms)";
+      }
+      if (run.cold && !result.cold) {
+        std::cout << " (page cache not dropped)";
+      }
+      std::cout << '\n';
+    }
+  }
+  std::cout << std::flush;
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char **argv) {
+  AppOptions options;
+  if (!ParseOptions(argc, argv, options)) {
+    return EXIT_FAILURE;
+  }
+  if (options.benchDenormals) {
+    return RunDenormalBenchmark();
+  }
+  if (options.benchConversion) {
+    return RunConversionBenchmark();
+  }
+  if (options.benchBars) {
+    return RunBarBenchmark();
+  }
+  if (options.benchBuckets) {
+    return RunBucketBenchmark();
+  }
+  if (options.benchIo) {
+    return RunIoBenchmark(options);
+  }
+  if (options.benchBroadcast) {
+    return RunBroadcastBenchmark();
+  }
+  if (options.benchTripleBuffer) {
+    return RunTripleBufferBenchmark();
+  }
+  if (options.benchSnapshot) {
+    return RunSnapshotBenchmark();
+  }
+  if (options.benchDrain) {
+    return RunDrainBenchmark();
+  }
+  if (options.offline) {
+    return RunOffline(options);
+  }
+  if (options.precompute) {
+    return RunPrecompute(options);
+  }
+  if (options.batch) {
+    return RunBatch(options);
+  }
+
+  SpectralCache cache;
+  if (options.useCache &&
+      !cache.Open(SpectralCache::PathFor(options.filePath))) {
+    return EXIT_FAILURE;
+  }
+
+  std::string filePath = options.filePath;
+  TripleBuffer<AnalysisFrame> tripleBuffer;
+
+  // single-producer, multi-reader ring fed by the audio callback; the
+  // analyzer and the recorder each read it at their own pace
+  BroadcastRing output;
+
+  AudioEngine audioObj(output, filePath);
+  audioObj.Configure(EngineSettings(options));
 
   // launched as a functor in its overloaded operator()
-  AnalyzerThread analyzerThread(std::ref(sharedRingBuffer),
-                                std::ref(tripleBuffer), std::ref(doneFlag));
+  AnalyzerThread analyzerThread(std::ref(output), std::ref(tripleBuffer),
+                                std::ref(doneFlag));
+  Recorder recorder(output);
 
-  analyzerThread.Launch();
   if (!audioObj.Init()) {
     return EXIT_FAILURE;
   }
+  if (!cache.isOpen()) {
+    analyzerThread.Configure(audioObj.GetSampleRate(), options.analysisRate);
+    analyzerThread.SetTuning(options.analyzerTuning);
+    analyzerThread.Launch();
+  }
+  const bool recording = !options.recordPath.empty();
+  if (recording) {
+    if (!recorder.Open(options.recordPath, audioObj.GetSampleRate())) {
+      return EXIT_FAILURE;
+    }
+    recorder.Launch();
+  }
 
   audioObj.Start();
 
   GraphicsThread visualizer{SCREEN_HEIGHT, SCREEN_WIDTH, tripleBuffer};
   visualizer.Initialize(); // initialize window and constants
+  if (!options.capture && !options.loopback) {
+    visualizer.SetPlaybackClock(
+        [&audioObj] { return audioObj.GetAudibleFrame(); },
+        audioObj.GetSampleRate());
+  }
+  if (cache.isOpen()) {
+    visualizer.UseCache(&cache,
+                        [&audioObj] { return audioObj.GetAudibleSourceFrame(); });
+  }
+  visualizer.ShowDeadlineMonitor(&audioObj.GetDeadlineMonitor());
+  // last, so the threads started above do not inherit the render thread's
+  // affinity or policy
+  ThreadTuning::Apply("render", options.renderTuning);
+  const bool transport = !options.capture && !options.loopback;
+  int64_t loopStart = -1;
   while (!WindowShouldClose()) {
+    if (transport) {
+      HandleTransportKeys(audioObj, loopStart);
+    }
     BeginDrawing();
     ClearBackground(BLACK);
     visualizer.Update();
@@ -50,5 +613,8 @@ int main() {
   }
 
   doneFlag.store(true);
+  recorder.Stop();
+  PrintTelemetry(output, analyzerThread, recording ? &recorder : nullptr,
+                 audioObj, visualizer);
   return EXIT_SUCCESS;
 }
\ No newline at end of file